@@ -0,0 +1,305 @@
+/*
+作	用：比较cjson.hpp的C++封装和直接调用C接口的开销。在与bench.c中records相同结构的文档上，
+	    分别用两种方式解析后释放、遍历所有成员、按键名取出每条记录的字段，两种方式的结果必须相同。
+	    另外比较cjson_reflect.hpp直接读写结构体数组和经过树的方式，并检查64位整数成员能原样往返。
+用	法：bench_cpp [-t 每项最少秒数]
+输	出：与bench_cjson相同格式的JSON行，C接口和C++封装的op名字分别以_c和_cpp结尾
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "cjson_reflect.hpp"
+
+#ifndef BENCH_REV
+#define BENCH_REV "unknown"
+#endif
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long long seed = 88172645463325252ULL;
+
+static unsigned rnd()
+{
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned)(seed >> 33);
+}
+
+// 3万条地址记录，与bench.c中的records文档相同
+static std::string gen_records()
+{
+    std::string t = "[";
+    char record[256];
+    for (int i = 0; i < 30000; i++)
+    {
+        snprintf(record,sizeof(record),"%s{\"precision\":\"zip\",\"Latitude\":%.6f,\"Longitude\":%.6f,\"Address\":\"%u MAIN ST\",\"City\":\"CITY %u\",\"State\":\"CA\",\"Zip\":\"%05u\",\"Country\":\"US\"}",
+            i ? "," : "",(rnd() % 180000000) / 1e6 - 90,(rnd() % 360000000) / 1e6 - 180,rnd() % 10000,rnd() % 1000,rnd() % 100000);
+        t += record;
+    }
+    t += "]";
+    return t;
+}
+
+static const char* const keys[] = {"precision","Latitude","Longitude","Address","City","State","Zip","Country"};
+
+// 遍历：数值求和，字符串和键名累加长度
+static double walk_c(cJSON* root)
+{
+    double sum = 0;
+    for (cJSON* rec = root->child; rec; rec = rec->next)
+    {
+        for (cJSON* m = rec->child; m; m = m->next)
+        {
+            sum += strlen(m->string);
+            if ((m->type & 255) == cJSON_Number)
+            {
+                sum += cJSON_GetNumberValue(m);
+            }else if ((m->type & 255) == cJSON_String)
+            {
+                sum += strlen(cJSON_GetStringValue(m));
+            }
+        }
+    }
+    return sum;
+}
+
+static double walk_cpp(const cjson::document& doc)
+{
+    double sum = 0;
+    for (cjson::node rec : doc)
+    {
+        for (cjson::node m : rec)
+        {
+            sum += m.key().size();
+            if (m.is_number())
+            {
+                sum += m.get<double>();
+            }else if (m.is_string())
+            {
+                sum += m.get<std::string_view>().size();
+            }
+        }
+    }
+    return sum;
+}
+
+// 按键名查找：每条记录的8个字段都用名字取一次
+static double lookup_c(cJSON* root)
+{
+    double sum = 0;
+    for (cJSON* rec = root->child; rec; rec = rec->next)
+    {
+        for (const char* key : keys)
+        {
+            cJSON* m = cJSON_GetObjectItem(rec,key);
+            if (m && (m->type & 255) == cJSON_Number)
+            {
+                sum += cJSON_GetNumberValue(m);
+            }else if (m && (m->type & 255) == cJSON_String)
+            {
+                sum += strlen(cJSON_GetStringValue(m));
+            }
+        }
+    }
+    return sum;
+}
+
+static double lookup_cpp(const cjson::document& doc)
+{
+    static const std::string_view views[] = {"precision","Latitude","Longitude","Address","City","State","Zip","Country"};
+    double sum = 0;
+    for (cjson::node rec : doc)
+    {
+        for (std::string_view key : views)
+        {
+            cjson::node m = rec[key];
+            if (m.is_number())
+            {
+                sum += m.get<double>();
+            }else if (m.is_string())
+            {
+                sum += m.get<std::string_view>().size();
+            }
+        }
+    }
+    return sum;
+}
+
+struct record
+{
+    std::string precision;
+    double lat = 0, lon = 0;
+    std::string address, city, state, zip, country;
+};
+
+CJSON_REFLECT(record,
+    field("precision",&record::precision),
+    field("Latitude",&record::lat),
+    field("Longitude",&record::lon),
+    field("Address",&record::address),
+    field("City",&record::city),
+    field("State",&record::state),
+    field("Zip",&record::zip),
+    field("Country",&record::country));
+
+// 64位整数成员不经过double，超过2^53的值也要原样往返，超出范围的值饱和
+struct integers
+{
+    std::int64_t min = 0, max = 0;
+    std::uint64_t umax = 0;
+    std::vector<std::int64_t> list;
+};
+
+CJSON_REFLECT(integers,
+    field("min",&integers::min),
+    field("max",&integers::max),
+    field("umax",&integers::umax),
+    field("list",&integers::list));
+
+static bool check_integers()
+{
+    integers in;
+    integers out;
+    integers big;
+    in.min = INT64_MIN;
+    in.max = INT64_MAX;
+    in.umax = UINT64_MAX;
+    in.list = {9007199254740993LL,-9007199254740993LL,0,-1};
+    std::string text = cjson::to_json(in);
+    return text == "{\"min\":-9223372036854775808,\"max\":9223372036854775807,\"umax\":18446744073709551615,"
+                   "\"list\":[9007199254740993,-9007199254740993,0,-1]}" &&
+        cjson::from_json(text,out) && out.min == in.min && out.max == in.max && out.umax == in.umax && out.list == in.list &&
+        cjson::from_json("{\"min\":-1e30,\"max\":99999999999999999999,\"umax\":-5}",big) &&
+        big.min == INT64_MIN && big.max == INT64_MAX && big.umax == 0;
+}
+
+// 经过树读结构体：解析后按键名取出字段，再释放树
+static void tree_parse_records(const std::string& text,std::vector<record>& out)
+{
+    cjson::document doc = cjson::document::parse(text);
+    out.clear();
+    for (cjson::node rec : doc)
+    {
+        record r;
+        r.precision = rec["precision"].get<std::string_view>();
+        r.lat = rec["Latitude"].get<double>();
+        r.lon = rec["Longitude"].get<double>();
+        r.address = rec["Address"].get<std::string_view>();
+        r.city = rec["City"].get<std::string_view>();
+        r.state = rec["State"].get<std::string_view>();
+        r.zip = rec["Zip"].get<std::string_view>();
+        r.country = rec["Country"].get<std::string_view>();
+        out.push_back(std::move(r));
+    }
+}
+
+// 经过树写结构体：建树后打印，再释放树
+static std::string tree_print_records(const std::vector<record>& recs)
+{
+    cjson::document doc(cJSON_CreateArray());
+    cJSON* tail = nullptr;
+    for (const record& r : recs)
+    {
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item,"precision",r.precision.c_str());
+        cJSON_AddNumberToObject(item,"Latitude",r.lat);
+        cJSON_AddNumberToObject(item,"Longitude",r.lon);
+        cJSON_AddStringToObject(item,"Address",r.address.c_str());
+        cJSON_AddStringToObject(item,"City",r.city.c_str());
+        cJSON_AddStringToObject(item,"State",r.state.c_str());
+        cJSON_AddStringToObject(item,"Zip",r.zip.c_str());
+        cJSON_AddStringToObject(item,"Country",r.country.c_str());
+        // 直接接到尾部，cJSON_AddItemToArray每次都要从头找到尾
+        if (tail)
+        {
+            tail->next = item;
+            item->prev = tail;
+        }else{
+            doc.get()->child = item;
+        }
+        tail = item;
+    }
+    return std::string(doc.print_unformatted().view());
+}
+
+static double min_seconds = 0.3;
+static volatile double sink;
+
+template <class F>
+static void measure(const char* op,size_t bytes,F f)
+{
+    long iters = 0;
+    double elapsed = 0;
+    f();
+    while (elapsed < min_seconds)
+    {
+        double start = now();
+        f();
+        elapsed += now() - start;
+        iters++;
+    }
+    printf("{\"rev\":\"%s\",\"doc\":\"records\",\"op\":\"%s\",\"bytes\":%lu,\"iters\":%ld,\"seconds\":%.6f,\"mb_per_s\":%.2f}\n",
+        BENCH_REV,op,(unsigned long)bytes,iters,elapsed,bytes * (double)iters / elapsed / 1e6);
+}
+
+int main(int argc,char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i],"-t") && i + 1 < argc)
+        {
+            min_seconds = atof(argv[++i]);
+        }
+    }
+    std::string text = gen_records();
+    size_t bytes = text.size();
+    cjson::document doc = cjson::document::parse(text);
+    if (!doc)
+    {
+        fprintf(stderr,"records: parse error\n");
+        return 1;
+    }
+    if (walk_c(doc.get()) != walk_cpp(doc) || lookup_c(doc.get()) != lookup_cpp(doc))
+    {
+        fprintf(stderr,"records: C and C++ results differ\n");
+        return 1;
+    }
+
+    measure("parse_c",bytes,[&] { cJSON_Delete(cJSON_Parse(text.c_str())); });
+    measure("parse_cpp",bytes,[&] { cjson::document::parse(text); });
+    measure("walk_c",bytes,[&] { sink = walk_c(doc.get()); });
+    measure("walk_cpp",bytes,[&] { sink = walk_cpp(doc); });
+    measure("lookup_c",bytes,[&] { sink = lookup_c(doc.get()); });
+    measure("lookup_cpp",bytes,[&] { sink = lookup_cpp(doc); });
+    measure("print_c",bytes,[&] { cJSON_Free(cJSON_PrintUnformatted(doc.get())); });
+    measure("print_cpp",bytes,[&] { doc.print_unformatted(); });
+
+    std::vector<record> recs;
+    std::vector<record> scratch;
+    tree_parse_records(text,scratch);
+    if (!cjson::from_json(text,recs) || cjson::to_json(recs) != tree_print_records(scratch) ||
+        cjson::to_json(recs) != std::string(doc.print_unformatted().view()))
+    {
+        fprintf(stderr,"records: reflected and tree results differ\n");
+        return 1;
+    }
+    if (!check_integers())
+    {
+        fprintf(stderr,"integers: 64-bit members do not round-trip\n");
+        return 1;
+    }
+    measure("tree_parse_struct",bytes,[&] { tree_parse_records(text,scratch); });
+    measure("reflect_parse",bytes,[&] { cjson::from_json(text,scratch); });
+    measure("tree_print_struct",bytes,[&] { tree_print_records(recs); });
+    measure("reflect_print",bytes,[&] { cjson::to_json(recs); });
+    return 0;
+}
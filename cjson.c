@@ -1,3 +1,7 @@
+// -std=c99下mmap的MAP_ANONYMOUS、madvise等POSIX/BSD扩展不会声明，要在包含系统头文件之前打开
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
@@ -5,22 +9,162 @@
 #include <float.h>
 #include <limits.h>
 #include <ctype.h>
+#include <locale.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CJSON_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 #include "cjson.h"
 
+// 最低位的1的位置，x不为0
+#if defined(_MSC_VER)
+static int lowest_bit(unsigned long long x){
+    unsigned long i;
+    if ((unsigned)x)
+    {
+        _BitScanForward(&i,(unsigned)x);
+        return (int)i;
+    }
+    _BitScanForward(&i,(unsigned)(x >> 32));
+    return (int)i + 32;
+}
+#else
+#define lowest_bit(x) __builtin_ctzll(x)
+#endif
+
 // 使用函数指针，将cJSON_malloc指向malloc函数，从而完成内存申请，
 // static设置为静态函数 将其连接属性设置为内部，即仅可在当前文件访问，调用cJSON_malloc等价于调用malloc
 static void *(*cJSON_malloc)(size_t sz) = malloc;
 //作用同前面的cJSON_malloc，注意函数指针的类型要与指向的函数的类型完全相同，返回值和参数列表
 static void (*cJSON_free)(void *ptr) = free;
+// 为0时用申请、复制、释放代替
+static void *(*cJSON_realloc)(void *ptr,size_t sz) = realloc;
+
+// 线程局部变量，每个线程各自一份
+#if defined(_MSC_VER)
+#define CJSON_THREAD_LOCAL __declspec(thread)
+#else
+#define CJSON_THREAD_LOCAL __thread
+#endif
+
+// 内存统计：申请和释放按用途分类计入当前线程的统计块，没有统计块时不做任何统计
+enum { MEM_NODE, MEM_STRING, MEM_PRINT, MEM_OTHER };
+
+static CJSON_THREAD_LOCAL cJSON_MemoryStats* mem_stats;
+
+cJSON_MemoryStats* cJSON_UseMemoryStats(cJSON_MemoryStats* stats){
+    cJSON_MemoryStats* prev = mem_stats;
+    mem_stats = stats;
+    return prev;
+}
+
+// kind类的内存从oldsize字节变为newsize字节，减少时依靠无符号数的回绕得到正确结果
+static void mem_account(int kind,size_t oldsize,size_t newsize){
+    cJSON_MemoryStats* s = mem_stats;
+    size_t* live;
+    size_t* total;
+    if (!s)
+    {
+        return;
+    }
+    switch (kind)
+    {
+    case MEM_NODE:
+        live = &s->node_bytes;
+        total = &s->total_node_bytes;
+        break;
+    case MEM_STRING:
+        live = &s->string_bytes;
+        total = &s->total_string_bytes;
+        break;
+    case MEM_PRINT:
+        live = &s->print_bytes;
+        total = &s->total_print_bytes;
+        break;
+    default:
+        live = &s->other_bytes;
+        total = &s->total_other_bytes;
+        break;
+    }
+    *live += newsize - oldsize;
+    s->live_bytes += newsize - oldsize;
+    if (newsize > oldsize)
+    {
+        *total += newsize - oldsize;
+        if (s->live_bytes > s->peak_bytes)
+        {
+            s->peak_bytes = s->live_bytes;
+        }
+    }
+}
+
+// 申请size字节并计入kind类
+static void* mem_alloc(size_t size,int kind){
+    void* ptr = cJSON_malloc(size);
+    if (ptr && mem_stats)
+    {
+        mem_stats->allocs++;
+        mem_account(kind,0,size);
+    }
+    return ptr;
+}
+
+// 释放ptr，它在kind类中计了size字节
+static void mem_free(void* ptr,size_t size,int kind){
+    if (ptr && mem_stats)
+    {
+        mem_stats->frees++;
+        mem_account(kind,size,0);
+    }
+    cJSON_free(ptr);
+}
+
+// 把kind类中oldsize字节的ptr调整为newsize字节并保留内容，失败时ptr不变
+// realloc可以原地扩大，大块内存（glibc中由mmap分配）扩大时用mremap重新映射页面，不复制数据
+static void* mem_realloc(void* ptr,size_t oldsize,size_t newsize,int kind){
+    void* newptr;
+    if (!cJSON_realloc)
+    {
+        newptr = mem_alloc(newsize,kind);
+        if (newptr && ptr)
+        {
+            memcpy(newptr,ptr,oldsize < newsize ? oldsize : newsize);
+            mem_free(ptr,oldsize,kind);
+        }
+        return newptr;
+    }
+    newptr = cJSON_realloc(ptr,newsize);
+    if (newptr && mem_stats)
+    {
+        mem_stats->reallocs++;
+        mem_account(kind,oldsize,newsize);
+    }
+    return newptr;
+}
+
+// 统计打开时才计算字符串长度，关闭统计时不增加开销
+#define mem_strsize(s) (mem_stats ? strlen(s) + 1 : 0)
 
-// 将字符串的内容存放到动态内存指定的位置
+// 将字符串的内容存放到动态内存指定的位置，只用于打印null/false/true，所以计入打印缓冲区
 static char* cJSON_strdup(const char* str)  // 复制一段字符串
 {
     size_t len;
     char* copy;
     // 加1的原因是需要多申请一个字节的长度存放'\0'
     len = strlen(str) + 1;
-    if (!(copy = (char*)cJSON_malloc(len))){
+    if (!(copy = (char*)mem_alloc(len,MEM_PRINT))){
         return 0;
     }
     // 从str中赋值len长度的内容，会自动在copy后面加'\0',而strncpy则需要手动赋字符串末尾为'\0'
@@ -28,6 +172,233 @@ static char* cJSON_strdup(const char* str)  // 复制一段字符串
     return copy;
 }
 
+#ifdef CJSON_COMPACT
+// 判断字符串s是否存放在结点item内部
+#define cJSON_IsInline(item,s) ((s) >= (item)->inlinebuf && (s) < (item)->inlinebuf + cJSON_InlineSize)
+#endif
+
+// 结点的值字符串，紧凑布局下valuestring和valuedouble共用内存，必须先判断类型
+#define node_valuestring(item) ((((item)->type & 255) == cJSON_String) ? (item)->valuestring : 0)
+
+// 为结点item申请size字节存放键或值，other是结点上已有的另一个字符串（键或值，可以为空）
+// 紧凑布局下优先使用inlinebuf中没有被other占用的部分，放不下时才申请内存
+static char* node_alloc_string(cJSON* item,const char* other,size_t size){
+#ifdef CJSON_COMPACT
+    size_t start = 0;
+    if (other && cJSON_IsInline(item,other))
+    {
+        // other前面的空间够用
+        if ((size_t)(other - item->inlinebuf) >= size)
+        {
+            return item->inlinebuf;
+        }
+        start = (size_t)(other - item->inlinebuf) + strlen(other) + 1;
+    }
+    if (cJSON_InlineSize - start >= size)
+    {
+        return item->inlinebuf + start;
+    }
+#else
+    (void)item;
+    (void)other;
+#endif
+    return (char*)mem_alloc(size,MEM_STRING);
+}
+
+// 为结点复制一份字符串str，作用同cJSON_strdup
+static char* node_strdup(cJSON* item,const char* other,const char* str){
+    size_t len = strlen(str) + 1;
+    char* copy = node_alloc_string(item,other,len);
+    if (copy)
+    {
+        memcpy(copy,str,len);
+    }
+    return copy;
+}
+
+// 释放结点上的字符串，存放在结点内部的不需要释放
+static void node_free_string(cJSON* item,char* str){
+#ifdef CJSON_COMPACT
+    if (cJSON_IsInline(item,str))
+    {
+        return;
+    }
+#else
+    (void)item;
+#endif
+    mem_free(str,mem_strsize(str),MEM_STRING);
+}
+
+// 键字符串池：开放寻址哈希表，字符串本身存放在按块申请的内存中，池释放之前地址不会变化
+struct cJSON_InternPool
+{
+    // 哈希表，容量是2的幂，空位为0
+    char** slots;
+    size_t capacity;
+    size_t count;
+    // 当前存放字符串的内存块，块的开头保存上一个块的地址，用来在释放池时串起所有的块
+    char* block;
+    size_t blockused;
+    size_t blocksize;
+    cJSON_InternStats stats;
+};
+
+// 当前线程正在使用的字符串池，为0时不做去重
+static CJSON_THREAD_LOCAL cJSON_InternPool* intern_pool;
+
+#define INTERN_BLOCK_SIZE 4096
+
+// FNV-1a哈希
+static size_t intern_hash(const char* str,size_t len){
+    size_t h = (size_t)2166136261u;
+    size_t i;
+    for (i = 0;i < len;i++)
+    {
+        h = (h ^ (unsigned char)str[i]) * 16777619u;
+    }
+    return h;
+}
+
+// 扩大哈希表到原来的两倍，重新放入所有字符串
+static int intern_grow(cJSON_InternPool* pool){
+    size_t newcap = pool->capacity ? pool->capacity * 2 : 64;
+    size_t i,j;
+    char** slots = (char**)mem_alloc(newcap * sizeof(char*),MEM_STRING);
+    if (!slots)
+    {
+        return 0;
+    }
+    memset(slots,0,newcap * sizeof(char*));
+    for (i = 0;i < pool->capacity;i++)
+    {
+        if (pool->slots[i])
+        {
+            j = intern_hash(pool->slots[i],strlen(pool->slots[i])) & (newcap - 1);
+            while (slots[j])
+            {
+                j = (j + 1) & (newcap - 1);
+            }
+            slots[j] = pool->slots[i];
+        }
+    }
+    mem_free(pool->slots,pool->capacity * sizeof(char*),MEM_STRING);
+    pool->slots = slots;
+    pool->capacity = newcap;
+    return 1;
+}
+
+// 返回池中与str[0,len)相同的字符串，没有的话复制一份放入池中，str不需要以'\0'结尾
+static char* intern_string(cJSON_InternPool* pool,const char* str,size_t len){
+    size_t i;
+    char* copy;
+    char* block;
+    // 装载因子不超过1/2
+    if ((pool->count + 1) * 2 > pool->capacity && !intern_grow(pool))
+    {
+        return 0;
+    }
+    i = intern_hash(str,len) & (pool->capacity - 1);
+    while (pool->slots[i])
+    {
+        // 池中的字符串可能比len短，用strncmp在它的'\0'处停下，不越界读取
+        if (!strncmp(pool->slots[i],str,len) && pool->slots[i][len] == 0)
+        {
+            pool->stats.hits++;
+            pool->stats.saved_bytes += len + 1;
+            return pool->slots[i];
+        }
+        i = (i + 1) & (pool->capacity - 1);
+    }
+    // 当前块放不下就申请新块，特别长的字符串单独占一块
+    if (!pool->block || pool->blockused + len + 1 > pool->blocksize)
+    {
+        size_t size = sizeof(char*) + len + 1;
+        if (size < INTERN_BLOCK_SIZE)
+        {
+            size = INTERN_BLOCK_SIZE;
+        }
+        block = (char*)mem_alloc(size,MEM_STRING);
+        if (!block)
+        {
+            return 0;
+        }
+        memcpy(block,&pool->block,sizeof(char*));
+        pool->block = block;
+        pool->blockused = sizeof(char*);
+        pool->blocksize = size;
+        pool->stats.bytes += size;
+    }
+    copy = pool->block + pool->blockused;
+    pool->blockused += len + 1;
+    memcpy(copy,str,len);
+    copy[len] = 0;
+    pool->slots[i] = copy;
+    pool->count++;
+    pool->stats.strings++;
+    return copy;
+}
+
+cJSON_InternPool* cJSON_CreateInternPool(void){
+    cJSON_InternPool* pool = (cJSON_InternPool*)mem_alloc(sizeof(cJSON_InternPool),MEM_OTHER);
+    if (pool)
+    {
+        memset(pool,0,sizeof(cJSON_InternPool));
+    }
+    return pool;
+}
+
+// 释放池和池中所有的字符串，使用这个池的树必须已经全部删除
+void cJSON_DeleteInternPool(cJSON_InternPool* pool){
+    char* block;
+    if (!pool)
+    {
+        return;
+    }
+    if (intern_pool == pool)
+    {
+        intern_pool = 0;
+    }
+    // 块的大小没有单独保存，总数记在stats.bytes中，最后一起扣除
+    while (pool->block)
+    {
+        memcpy(&block,pool->block,sizeof(char*));
+        mem_free(pool->block,0,MEM_STRING);
+        pool->block = block;
+    }
+    mem_account(MEM_STRING,pool->stats.bytes,0);
+    mem_free(pool->slots,pool->capacity * sizeof(char*),MEM_STRING);
+    mem_free(pool,sizeof(cJSON_InternPool),MEM_OTHER);
+}
+
+cJSON_InternPool* cJSON_UseInternPool(cJSON_InternPool* pool){
+    cJSON_InternPool* prev = intern_pool;
+    intern_pool = pool;
+    return prev;
+}
+
+void cJSON_GetInternStats(const cJSON_InternPool* pool,cJSON_InternStats* stats){
+    if (pool && stats)
+    {
+        *stats = pool->stats;
+    }
+}
+
+// 设置结点的键：使用字符串池时指向池中的字符串并标记cJSON_StringIsConst，否则复制一份
+static char* node_set_key(cJSON* item,const char* string){
+    size_t len = strlen(string);
+    if (intern_pool)
+    {
+        item->string = intern_string(intern_pool,string,len);
+        item->type |= cJSON_StringIsConst;
+    }else{
+        item->string = node_strdup(item,node_valuestring(item),string);
+        item->type &= ~cJSON_StringIsConst;
+    }
+    return item->string;
+}
+
+static int cJSON_Unshare(cJSON *item);
+
 static void suffix_object(cJSON *prev,cJSON* item){
     prev->next = item;
     item->prev = prev;
@@ -38,18 +409,33 @@ void cJSON_InitHooks(cJSON_Hooks* hooks){
     {
         cJSON_malloc = malloc;
         cJSON_free = free;
+        cJSON_realloc = realloc;
         return;
     }
     // 如果定义了，自使用自定义的内存管理函数
     cJSON_malloc = (hooks->malloc_fn)?hooks->malloc_fn:malloc;
 	cJSON_free	 = (hooks->free_fn)?hooks->free_fn:free;
+    // 自定义了malloc或free而没有realloc时，不能把它们的内存交给C库的realloc
+    cJSON_realloc = hooks->realloc_fn;
+    if (!cJSON_realloc && cJSON_malloc == malloc && cJSON_free == free)
+    {
+        cJSON_realloc = realloc;
+    }
+}
+
+// 打印结果等交给调用者的内存已经不计入统计，直接交给free钩子
+void cJSON_Free(void* ptr){
+    if (ptr)
+    {
+        cJSON_free(ptr);
+    }
 }
 
 // 下面是创建基本类型节点的方法
 // 创建一个节点
 static cJSON *cJSON_New_Item(void){
     // 申请分配内存
-    cJSON* node = (cJSON*)cJSON_malloc(sizeof(cJSON));
+    cJSON* node = (cJSON*)mem_alloc(sizeof(cJSON),MEM_NODE);
     if (node) // 如果内存分配成功，则初始化节点
     {
         memset(node,0,sizeof(cJSON));
@@ -103,11 +489,38 @@ cJSON* cJSON_CreateString(const char* string){
     if (item)
     {
         item->type = cJSON_String;
-        item->valuestring = cJSON_strdup(string);
+        item->valuestring = node_strdup(item,0,string);
     }
     return item;
 }
 
+// 替换字符串结点的值；原来的值是引用（原地解析、文件映射）时不释放，结点改为持有新的副本
+char* cJSON_SetValuestring(cJSON* object,const char* valuestring){
+    char* old;
+    char* copy;
+    size_t len;
+    if (!object || !valuestring || (object->type & 255) != cJSON_String)
+    {
+        return 0;
+    }
+    old = object->valuestring;
+    len = strlen(valuestring);
+    copy = node_alloc_string(object,object->string,len + 1);
+    if (!copy)
+    {
+        return 0;
+    }
+    // valuestring可能指向原来的值，紧凑布局下新值也可能放在原来的值所在的inlinebuf中
+    memmove(copy,valuestring,len + 1);
+    if (old && old != copy && !(object->type & cJSON_IsReference))
+    {
+        node_free_string(object,old);
+    }
+    object->valuestring = copy;
+    object->type &= ~cJSON_IsReference;
+    return copy;
+}
+
 cJSON* cJSON_CreateArray(void){
     cJSON* item = cJSON_New_Item();
     if (item)
@@ -195,23 +608,25 @@ void cJSON_AddItemToObject(cJSON *object,const char *string,cJSON *item){
         return;
     }
     // 判断子节点的键是否在之前已经指向了一块内存
-    if (item->string)
+    if (item->string && !(item->type & cJSON_StringIsConst))
     {
         // 如果已经分配过内存，释放此段内存
-        cJSON_free(item->string);
+        node_free_string(item,item->string);
     }
-    // 为string分配一段内存，item->string 指向这段内存
-    item->string = cJSON_strdup(string);
+    item->string = 0;
+    // 为string分配一段内存（或者使用字符串池中的字符串），item->string 指向这段内存
+    node_set_key(item,string);
     // 调用cJSON_AddItemToArray向root添加子节点。
     cJSON_AddItemToArray(object,item);
 }
 
 void cJSON_AddItemToArray(cJSON* array,cJSON* item){
-    cJSON *c = array->child;
-    if (!item)
+    cJSON *c;
+    if (!item || !cJSON_Unshare(array))
     {
         return;
     }
+    c = array->child;
     if (!c)
     {
         array->child = item;
@@ -230,34 +645,22 @@ typedef struct
     // 字符串指针
     char* buffer;
     // 长度
-    int length;
+    size_t length;
     // 位置偏置
-    int offset;
+    size_t offset;
 } printbuffer;
 
-/*返回 一个比x大的n(其中n是2的幂),并且是最小的幂，说白了就是将一个数后边所有的位都置1然后再+1*/
-//比如输入1返回2，输入3返回4，输入5返回8，输入9返回16，输入17返回32，比当前数大的最小2^n,这个函数的目的是支持动态内存的分配
-static int pow2gt(int x){
-    --x;
-	x |= x >> 1;
-	x |= x >> 2;
-	x |= x >> 4;
-	x |= x >> 8;
-	x |= x >> 16;
-	return x + 1;
-}
-
-// 个人认为：这个函数的目的是为buffer申请内存，由于计算机是使用2进制，所以使用pow2gt函数来确定申请空间的大小
+// 这个函数的目的是为buffer申请内存，空间不够时容量翻倍，保证打印的总时间是线性的
 // 以下是参看csdn博主的说法
 // 这里的目的是为了在格式化输出内容的时候，分配更多的动态内存用来存储换行符、制表符等奇怪的字符
 /* ensure 函数是一个协助 printbuffer 分配内存的一个函数  
  * len 表示当前字符串的字符串起始偏移量 即 newbuffer+p->offset 起始的
  */
-static char* ensure(printbuffer *p,int needed){
+static char* ensure(printbuffer *p,size_t needed){
     char *newbuffer;
-    int newsize;
+    size_t newsize;
     //传入参数合法性检测
-    if (!p || p->buffer)
+    if (!p || !p->buffer)
     {
         return 0;
     }
@@ -268,24 +671,32 @@ static char* ensure(printbuffer *p,int needed){
     {
         return p->buffer + p->offset;
     }
-    //内存不够用，申请malloc出新内存 放buffer里面的内容
-    newsize = pow2gt(needed);
-    newbuffer = (char*)cJSON_malloc(newsize);
+    //内存不够用，容量翻倍直到放得下，用realloc扩大，已经打印的内容保留在原处
+    newsize = p->length ? p->length : 1;
+    while (newsize < needed)
+    {
+        if (newsize > (size_t)-1 / 2)
+        {
+            newsize = needed;
+            break;
+        }
+        newsize *= 2;
+    }
+    newbuffer = (char*)mem_realloc(p->buffer,p->length,newsize,MEM_PRINT);
     if (!newbuffer)
     {
-        cJSON_free(p->buffer);
+        mem_free(p->buffer,p->length,MEM_PRINT);
         p->length = 0;
         p->buffer = 0;
         return 0;
     }
-    cJSON_free(p->buffer);
     p->length = newsize;
     p->buffer = newbuffer;
     return newbuffer + p->offset;
 }
 
 // 将给的数字类型结构体转换为字符串存储到p缓冲区中，若p为null就申请空间
-static int update(printbuffer *p)
+static size_t update(printbuffer *p)
 {
 	char *str;
 	if (!p || !p->buffer) return 0;
@@ -296,6 +707,7 @@ static int update(printbuffer *p)
 // 打印键值对中，值的内容为数字的cJSON结构体
 static char* print_number(cJSON* item,printbuffer* p){
     char *str = 0;
+    size_t size = 0;
     double d = item->valuedouble;
     // 对于是0的字符，直接分配内存
     if (d == 0)
@@ -306,7 +718,8 @@ static char* print_number(cJSON* item,printbuffer* p){
             str = ensure(p,2);
         }else{
             // 同上
-            str = (char*)cJSON_malloc(2);
+            size = 2;
+            str = (char*)mem_alloc(size,MEM_PRINT);
         }
         if (str)
         {
@@ -322,7 +735,8 @@ static char* print_number(cJSON* item,printbuffer* p){
             //int型数据，最大长度为21个字符
             str = ensure(p,21);
         }else{
-            str = (char*)cJSON_malloc(21);
+            size = 21;
+            str = (char*)mem_alloc(size,MEM_PRINT);
         }
         if (str)
         {
@@ -335,7 +749,8 @@ static char* print_number(cJSON* item,printbuffer* p){
         {
             str = ensure(p,64);
         }else{
-            str = (char*)cJSON_malloc(64);
+            size = 64;
+            str = (char*)mem_alloc(size,MEM_PRINT);
         }
         if (str)
         {
@@ -353,14 +768,71 @@ static char* print_number(cJSON* item,printbuffer* p){
             }
         }
     }
+    // 统计只计入实际写入的字节
+    if (size && str)
+    {
+        mem_account(MEM_PRINT,size,mem_strsize(str));
+    }
     return str;
 }
 
+// 每个字节转义后多出的字节数，0表示不需要转义：引号、反斜杠和\b \f \n \r \t打印成两个字节，
+// 其余ASCII码小于32的控制字符打印成\u00XX，多出5个字节
+static const unsigned char escape_extra[256] = {
+    5,5,5,5,5,5,5,5,1,1,1,5,1,1,5,5,
+    5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+    0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0
+};
+// 控制字符在反斜杠后面的字母，0表示打印成\u00XX
+static const char escape_letter[32] = {
+    0,0,0,0,0,0,0,0,'b','t','n',0,'f','r',0,0
+};
+static const char hex_chars[] = "0123456789abcdef";
+
+// str开始的len个字节中第一个需要转义的字节的位置，没有时返回len
+// 有SSE2时每次比较16个字节，打印和解析时都用它检查字符串，长字符串不再逐字节判断
+static size_t escape_find(const char* str,size_t len){
+    size_t i = 0;
+#ifdef CJSON_SSE2
+    const __m128i quote = _mm_set1_epi8('\"'),backslash = _mm_set1_epi8('\\'),control = _mm_set1_epi8(31);
+    __m128i v;
+    unsigned mask;
+    for (;i + 16 <= len;i += 16)
+    {
+        v = _mm_loadu_si128((const __m128i*)(str + i));
+        // 无符号的max(v,31)==31即v<=31
+        mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v,quote),_mm_cmpeq_epi8(v,backslash)),
+                                                        _mm_cmpeq_epi8(_mm_max_epu8(v,control),control)));
+        if (mask)
+        {
+            return i + lowest_bit(mask);
+        }
+    }
+#endif
+    while (i < len && !escape_extra[(unsigned char)str[i]])
+    {
+        i++;
+    }
+    return i;
+}
+
+//计算长度为len的str转义之后的字节数，不包括两边的引号和结尾的'\0'
+static size_t escaped_length(const char* str,size_t len){
+    size_t size = len,i;
+    for (i = escape_find(str,len);i < len;i += 1 + escape_find(str + i + 1,len - i - 1))
+    {
+        size += escape_extra[(unsigned char)str[i]];
+    }
+    return size;
+}
+
 //打印字符串类型的结点
 static char* print_string_ptr(const char* str,printbuffer* p){
-    const char *ptr;
     char* ptr2,*out;
-    int len = 0,flag = 0;
+    size_t len,size,i,j;
     unsigned char token;
     // 如果传入的字符串是空的，则存储字符串标志\"和\"
     if (!str)
@@ -369,7 +841,7 @@ static char* print_string_ptr(const char* str,printbuffer* p){
         {
             out = ensure(p,3);
         }else{
-            out = (char*)cJSON_malloc(3);
+            out = (char*)mem_alloc(3,MEM_PRINT);
         }
         if (!out)
         {
@@ -379,107 +851,54 @@ static char* print_string_ptr(const char* str,printbuffer* p){
         strcpy(out,"\"\"");
         return out;
     }
-    // 判断字符串是否包含特殊字符
-    for (ptr = str;*ptr;ptr++){
-        flag |= ((*ptr > 0 && *ptr < 32) || (*ptr == '\"') || (*ptr == '\\')) ? 1 : 0;
-    }
-    // 若没有特殊字符，则直接在字符串两边加入双引号即可
-    if (!flag)
-    {
-        len = ptr - str;
-        if (p)
-        {
-            out = ensure(p,len + 3);
-        }else{
-            out = (char*)cJSON_malloc(len + 3);
-        }
-        if (!out)
-        {
-            return 0;
-        }
-        ptr2 = out;
-        *ptr2++ = '\"';
-        strcpy(ptr2,str);
-        ptr2[len] = '\"';
-        ptr2[len + 1] = 0;
-        // 这里由于ptr2指向out一样的内存，因此当改变ptr2指向的内容后，out的内容也会跟着变
-        return out;
-    }
-    // 指向str
-    ptr = str;
-    //这里的作用是计算为了存储字符串需要多少个字节的内存，使用len来记录。
-    while ((token = *ptr) && ++len)
-    {
-        // 注意这里在while和if else语句中都进行了对len进行＋的操作，
-        // 主要是因为这些奇怪的字符需要加斜杠\,while中的++Len操作就是获取存储\需要的内存数。
-        // strchr对字符串中的单个字符进行查找，找到了的话返回指向对应的位置指针，否则返回NULL
-        if (strchr("\"\\\b\f\n\r\t", token))
-        {
-            //这里相当于每找到"\"\\\b\f\n\r\t"中的一个字符，len就加2
-            len++;
-        }else if (token < 2)
-        {
-            //这里相当于每找到ASCII为32以内的字符，len就加6
-            len += 5;
-        }
-        //获取下一个字符
-        ptr++;
-    }
+    len = strlen(str);
+    // 第一个需要转义的字节，没有时整个字符串原样复制
+    i = escape_find(str,len);
+    size = (i == len) ? len : i + escaped_length(str + i,len - i);
     if (p)
     {
-        out = ensure(p,len + 3);
+        out = ensure(p,size + 3);
     }else{
-        out = (char*)cJSON_malloc(len + 3);
+        out = (char*)mem_alloc(size + 3,MEM_PRINT);
     }
     if (!out)
     {
         return 0;
     }
     ptr2 = out;
-    ptr = str;
     *ptr2++ = '\"';
-    while (*ptr)
+    j = 0;
+    // 两个转义字符之间的常规字符整段memcpy，转义字符查表写出，不再用sprintf
+    while (1)
     {
-        if ((unsigned char)*ptr > 31 && *ptr != '\"' && *ptr != '\\')
+        memcpy(ptr2,str + j,i - j);
+        ptr2 += i - j;
+        if (i == len)
         {
-            //常规字符,直接将字符存储到ptr2中
-            *ptr2++ = *ptr++;
+            break;
+        }
+        token = (unsigned char)str[i];
+        *ptr2++ = '\\';
+        if (token == '\"' || token == '\\')
+        {
+            *ptr2++ = (char)token;
+        }else if (escape_letter[token])
+        {
+            *ptr2++ = escape_letter[token];
         }else{
-            // 奇怪的字符，一般以是\+字符的组合，故先存储一个'\\'字符
-			*ptr2++ = '\\';
-			switch (token = *ptr++) {
-			case '\\': // 存储'\\'
-				*ptr2++ = '\\';
-				break;
-			case '\"': //存储'\"'
-				*ptr2++ = '\"';
-				break;
-			case '\b'://存储'b'
-				*ptr2++ = 'b';
-				break;
-			case '\f'://存储'f'
-				*ptr2++ = 'f';
-				break;
-			case '\n'://存储'n'
-				*ptr2++ = 'n';
-				break;
-			case '\r'://存储'r'
-				*ptr2++ = 'r';
-				break;
-			case '\t'://存储't'
-				*ptr2++ = 't';
-				break;
-			default:
-				sprintf(ptr2, "u%04x", token);
-                //奇怪的字符，除了存储'\\',还需再移动五个位置，存储它
-				ptr2 += 5; 
-				break;
-			}
+            ptr2[0] = 'u';
+            ptr2[1] = '0';
+            ptr2[2] = '0';
+            ptr2[3] = hex_chars[token >> 4];
+            ptr2[4] = hex_chars[token & 15];
+            ptr2 += 5;
         }
+        j = i + 1;
+        i = j + escape_find(str + j,len - j);
     }
     // 在末尾添加字符串结束标志
     *ptr2++ = '\"';
-    *ptr2++ = 0;
+    *ptr2 = 0;
     return out;
 }
 
@@ -487,32 +906,85 @@ static char* print_string(cJSON* item,printbuffer* p){
     return print_string_ptr(item->valuestring,p);
 }
 
+// 解析时数组和对象允许的最大嵌套层数，可以用cJSON_SetNestingLimit修改；和strict_strings一样每个线程一份，互不影响
+static CJSON_THREAD_LOCAL size_t nesting_limit = CJSON_NESTING_LIMIT;
+
+// parse_value放在函数栈上的容器栈大小，更深的嵌套才需要申请内存
+#define PARSE_STACK_SIZE 32
+
+// cJSON_Validate和skip_value中嵌套层数的上限，容器的种类每层一位，存放在函数栈上
+#define VALIDATE_DEPTH 65536
+
+size_t cJSON_SetNestingLimit(size_t limit){
+    size_t prev = nesting_limit;
+    nesting_limit = limit;
+    return prev;
+}
+
+// 当前线程解析文本时是否严格检查字符串
+static CJSON_THREAD_LOCAL int strict_strings;
+
+int cJSON_SetStrictStrings(int strict){
+    int prev = strict_strings;
+    strict_strings = strict;
+    return prev;
+}
+
+// 解析过程中需要传递的状态，由各个parse_*函数层层传递
+typedef struct
+{
+    // 非0时为原地解析：字符串直接在输入缓冲区中解码，节点引用缓冲区而不另外申请内存
+    int insitu;
+    // 不为0时对象的键从字符串池中取，相同的键只保存一份
+    cJSON_InternPool* pool;
+    // 非0时严格检查字符串（见cJSON_SetStrictStrings），end是文本结尾的'\0'，限定按块读取的范围
+    int strict;
+    const char* end;
+} parse_context;
+
 /* Predeclare these prototypes. */
-static const char *parse_value(cJSON *item,const char *value);
 static char *print_value(cJSON *item,int depth,int fmt,printbuffer *p);
-static const char *parse_array(cJSON *item,const char *value);
 static char *print_array(cJSON *item,int depth,int fmt,printbuffer *p);
-static const char *parse_object(cJSON *item,const char *value);
 static char *print_object(cJSON *item,int depth,int fmt,printbuffer *p);
 
 // 无格式打印
+// 返回的字符串交给调用者释放，从统计中扣除
 char* cJSON_Print(cJSON* item){
-    return print_value(item,0,1,0);
+    char* out = print_value(item,0,1,0);
+    if (out)
+    {
+        mem_account(MEM_PRINT,mem_strsize(out),0);
+    }
+    return out;
 }
 
 // 格式化打印
 char* cJSON_PrintUnformatted(cJSON* item){
-    return print_value(item,0,0,0);
+    char* out = print_value(item,0,0,0);
+    if (out)
+    {
+        mem_account(MEM_PRINT,mem_strsize(out),0);
+    }
+    return out;
 }
 
 // 使用buffer打印
 char *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt){
     printbuffer p;
-    p.buffer = (char*)cJSON_malloc(prebuffer);
+    char* out;
+    if (prebuffer <= 0)
+    {
+        prebuffer = 256;
+    }
+    p.buffer = (char*)mem_alloc(prebuffer,MEM_PRINT);
     p.length = prebuffer;
     p.offset = 0;
-    return print_value(item,0,fmt,&p);
-    return p.buffer;
+    out = print_value(item,0,fmt,&p);
+    if (out)
+    {
+        mem_account(MEM_PRINT,p.length,0);
+    }
+    return out;
 }
 
 static char* print_value(cJSON* item,int depth,int fmt,printbuffer* p){
@@ -605,6 +1077,8 @@ static char* print_array(cJSON* item,int depth,int fmt,printbuffer* p){
     //  numentries记录子节点的个数
     int numertries = 0,i = 0,fail = 0;
     size_t tmplen = 0;
+    // 使用buffer打印时本结点输出的起始位置，buffer扩大时地址可能改变，所以记录偏移
+    size_t start;
 
     /* 查看数组里有多少个元素 */
     while (child)
@@ -624,7 +1098,7 @@ static char* print_array(cJSON* item,int depth,int fmt,printbuffer* p){
             out = ensure(p,3);
         }else{
             // 申请三个字节的内存，存储这个空壳子
-            out = (char*)cJSON_malloc(3);
+            out = (char*)mem_alloc(3,MEM_PRINT);
         }
         if (out)
         {
@@ -638,7 +1112,7 @@ static char* print_array(cJSON* item,int depth,int fmt,printbuffer* p){
     if (p)
     {
         /* 组成数组的输出形式 */
-        i = p->offset;
+        start = p->offset;
         ptr = ensure(p,1);
         if (!ptr)
         {
@@ -676,9 +1150,9 @@ static char* print_array(cJSON* item,int depth,int fmt,printbuffer* p){
         }
         *ptr++ = ']';
         *ptr = 0;
-        out = (p->buffer) + i;
+        out = (p->buffer) + start;
     }else{
-        entries = (char**) cJSON_malloc(numertries * sizeof(char*));
+        entries = (char**) mem_alloc(numertries * sizeof(char*),MEM_PRINT);
         if (!entries)
         {
             return 0;
@@ -699,7 +1173,7 @@ static char* print_array(cJSON* item,int depth,int fmt,printbuffer* p){
         }
         if (!fail)
         {
-            out = (char*)cJSON_malloc(len);
+            out = (char*)mem_alloc(len,MEM_PRINT);
         }
         if (!out)
         {
@@ -710,11 +1184,11 @@ static char* print_array(cJSON* item,int depth,int fmt,printbuffer* p){
             for(int i = 0;i < numertries;i++){
                 if (entries[i])
                 {
-                    cJSON_free(entries[i]);
+                    mem_free(entries[i],mem_strsize(entries[i]),MEM_PRINT);
                 }
-                cJSON_free(entries);
-                return 0;
             }
+            mem_free(entries,numertries * sizeof(char*),MEM_PRINT);
+            return 0;
         }
         *out = '[';
         ptr = out + 1;
@@ -732,12 +1206,13 @@ static char* print_array(cJSON* item,int depth,int fmt,printbuffer* p){
                 }
                 *ptr = 0;
             }
-            cJSON_free(entries[i]);
+            mem_free(entries[i],tmplen + 1,MEM_PRINT);
             
         }
-        cJSON_free(entries);
+        mem_free(entries,numertries * sizeof(char*),MEM_PRINT);
         *ptr++ = ']';
         *ptr++ = 0;
+        mem_account(MEM_PRINT,len,ptr - out);
     }
     return out;
 }
@@ -755,6 +1230,8 @@ static char* print_object(cJSON* item, int depth, int fmt,  printbuffer* p)
     // numentries用来统计含有多少子节点，主要为了给后面存储字符串申请内容
 	int numentries = 0, fail = 0; 
 	size_t tmplen = 0;
+	// 使用buffer打印时本结点输出的起始位置，不能用i记录，后面输出缩进时i会被改写
+	size_t start;
  
 	/* 统计有多少个子结点. */
 	while (child){
@@ -767,7 +1244,7 @@ static char* print_object(cJSON* item, int depth, int fmt,  printbuffer* p)
 		if (p)
 			out = ensure(p, fmt ? depth + 4 : 3);
 		else
-			out = (char *) cJSON_malloc(fmt ? depth + 4 : 3);
+			out = (char *) mem_alloc(fmt ? depth + 4 : 3,MEM_PRINT);
 		if (!out)
 			return 0;
 		ptr = out;
@@ -783,7 +1260,7 @@ static char* print_object(cJSON* item, int depth, int fmt,  printbuffer* p)
 	}
 	if (p) {//这里进行一些格式处理细节太多，不看了，知道是调整输出的格式即可
 		/* 组成输出形式: */
-		i = p->offset;
+		start = p->offset;
 		len = fmt ? 2 : 1;
 		ptr = ensure(p, len + 1);
 		if (!ptr)
@@ -839,17 +1316,17 @@ static char* print_object(cJSON* item, int depth, int fmt,  printbuffer* p)
 				*ptr++ = '\t';
 		*ptr++ = '}';
 		*ptr = 0;
-		out = (p->buffer) + i;
+		out = (p->buffer) + start;
 	} else {
 		/*为对象和名称分配空间，存储键和值对应的字符串 */
 		entries =
-		    (char **) cJSON_malloc(numentries * sizeof(char *));
+		    (char **) mem_alloc(numentries * sizeof(char *),MEM_PRINT);
 		if (!entries)
 			return 0;
 		names =
-		    (char **) cJSON_malloc(numentries * sizeof(char *));
+		    (char **) mem_alloc(numentries * sizeof(char *),MEM_PRINT);
 		if (!names) {  // 出错释放内存
-			cJSON_free(entries);
+			mem_free(entries,numentries * sizeof(char *),MEM_PRINT);
 			return 0;
 		}
 		memset(entries, 0, sizeof(char *) * numentries);  // 指定内容初始化为0
@@ -875,7 +1352,7 @@ static char* print_object(cJSON* item, int depth, int fmt,  printbuffer* p)
 		}
  
 		if (!fail)  // 存储键值的过程中如果没有出错的话，申请一段动态内存
-			out = (char *) cJSON_malloc(len);
+			out = (char *) mem_alloc(len,MEM_PRINT);
 		if (!out)  // 动态内存申请不成功的话，依旧设置fail为1，这样就可以进入接下来的if从而释放之前申请的动态内存
 			fail = 1;
  
@@ -883,12 +1360,12 @@ static char* print_object(cJSON* item, int depth, int fmt,  printbuffer* p)
 		if (fail) {
 			for (i = 0; i < numentries; i++) {
 				if (names[i]) // 对每个一级指针的内容逐渐释放其内存，仅当其内存的确存在才释放，注意内存释放的顺序
-					cJSON_free(names[i]);
+					mem_free(names[i], mem_strsize(names[i]), MEM_PRINT);
 				if (entries[i])
-					cJSON_free(entries[i]);
+					mem_free(entries[i], mem_strsize(entries[i]), MEM_PRINT);
 			}
-			cJSON_free(names);  // 释放存储了一组字符串的动态内存
-			cJSON_free(entries);
+			mem_free(names, numentries * sizeof(char *), MEM_PRINT);  // 释放存储了一组字符串的动态内存
+			mem_free(entries, numentries * sizeof(char *), MEM_PRINT);
 			return 0;
 		}
  
@@ -906,58 +1383,389 @@ static char* print_object(cJSON* item, int depth, int fmt,  printbuffer* p)
 			tmplen = strlen(names[i]);
 			memcpy(ptr, names[i], tmplen);
 			ptr += tmplen;
+			mem_free(names[i], tmplen + 1, MEM_PRINT);
 			*ptr++ = ':';
 			if (fmt)
 				*ptr++ = '\t';
-			strcpy(ptr, entries[i]);
-			ptr += strlen(entries[i]);
+			tmplen = strlen(entries[i]);
+			memcpy(ptr, entries[i], tmplen);
+			ptr += tmplen;
+			mem_free(entries[i], tmplen + 1, MEM_PRINT);
 			if (i != numentries - 1)
 				*ptr++ = ',';
 			if (fmt)
 				*ptr++ = '\n';
 			*ptr = 0;
-			cJSON_free(names[i]);
-			cJSON_free(entries[i]);
 		}
  
-		cJSON_free(names);
-		cJSON_free(entries);
+		mem_free(names, numentries * sizeof(char *), MEM_PRINT);
+		mem_free(entries, numentries * sizeof(char *), MEM_PRINT);
 		if (fmt)
 			for (i = 0; i < depth - 1; i++)
 				*ptr++ = '\t';
 		*ptr++ = '}';
 		*ptr++ = 0;
+		mem_account(MEM_PRINT, len, ptr - out);
 	}
 	return out;
 }
 
+// cJSON_ParseFile返回的根节点，额外记录文件映射区域，带cJSON_OwnsMapping标记，cJSON_Delete释放根节点时一并释放映射
+typedef struct
+{
+    // 必须是第一个成员，这样根节点的地址就是整个结构体的地址
+    cJSON item;
+    char* map;
+    size_t maplen;
+} cJSON_Mapped;
+
+// 把文件映射到内存，len返回文件长度，maplen返回映射区域的总长度
+// 映射区域在文件内容之后至少有一个为0的字节，可以直接作为以'\0'结尾的字符串原地解析
+static char* map_file(const char* path,size_t* len,size_t* maplen){
+#ifndef _WIN32
+    int fd;
+    struct stat st;
+    size_t page;
+    char* base;
+    fd = open(path,O_RDONLY);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    if (fstat(fd,&st) < 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return 0;
+    }
+    page = (size_t)sysconf(_SC_PAGESIZE);
+    *len = (size_t)st.st_size;
+    // 先保留一块比文件至少大一个字节、按页对齐的匿名区域，再把文件映射到它的开头：
+    // 文件最后一页超出文件长度的部分由内核补0；文件长度恰好是页大小的整数倍时，后面的匿名页提供'\0'
+    *maplen = (*len / page + 1) * page;
+    base = (char*)mmap(0,*maplen,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        return 0;
+    }
+    // MAP_PRIVATE：原地解析写入的'\0'和解码后的字符只会复制被写到的页，不会写回文件
+    if (mmap(base,*len,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_FIXED,fd,0) == MAP_FAILED)
+    {
+        munmap(base,*maplen);
+        close(fd);
+        return 0;
+    }
+    close(fd);
+    // 解析是从头到尾顺序扫描的，让内核加大预读；大文件尽量使用大页，减少缺页和TLB开销，失败也不影响解析
+    madvise(base,*len,MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(base,*maplen,MADV_HUGEPAGE);
+#endif
+    return base;
+#else
+    // 没有mmap的平台退化为一次性读入，缓冲区同样归返回的根节点所有
+    FILE* f;
+    long n;
+    char* data;
+    f = fopen(path,"rb");
+    if (!f)
+    {
+        return 0;
+    }
+    fseek(f,0,SEEK_END);
+    n = ftell(f);
+    fseek(f,0,SEEK_SET);
+    if (n <= 0 || !(data = (char*)mem_alloc((size_t)n + 1,MEM_OTHER)))
+    {
+        fclose(f);
+        return 0;
+    }
+    *len = fread(data,1,(size_t)n,f);
+    data[*len] = 0;
+    *maplen = (size_t)n + 1;
+    fclose(f);
+    return data;
+#endif
+}
+
+static void unmap_file(char* map,size_t maplen){
+#ifndef _WIN32
+    munmap(map,maplen);
+#else
+    mem_free(map,maplen,MEM_OTHER);
+#endif
+}
+
+// 写时复制的共享计数：refcount是链表头结点之外还有几个拥有者。共享同一份基础树的副本可能在不同的线程中修改和释放，
+// 所以增减都是原子操作；计数为0时只有自己拥有这条链表，别人无法再增加计数，可以直接修改
+#if defined(_MSC_VER)
+#define share_fetch_add(p,n) _InterlockedExchangeAdd((volatile long*)(p),(long)(n))
+#define share_load(p) _InterlockedCompareExchange((volatile long*)(p),0,0)
+#else
+#define share_fetch_add(p,n) __atomic_fetch_add((p),(n),__ATOMIC_ACQ_REL)
+#define share_load(p) __atomic_load_n((p),__ATOMIC_ACQUIRE)
+#endif
+
+static void share_acquire(cJSON* head){
+    share_fetch_add(&head->refcount,1);
+}
+
+// 放弃对链表的一份所有权，返回1表示没有别的拥有者了，调用者负责释放
+static int share_release(cJSON* head){
+    return !share_load(&head->refcount) || share_fetch_add(&head->refcount,-1) == 0;
+}
+
 // 传入需要删除的root指针，cjOSN结构形式
+// 不递归：遇到子结点链表时，把还没释放的同层后继压入栈中（借用它的prev成员串起来，反正这些结点马上就要释放），
+// 然后转去释放子结点链表，当前链表释放完后再从栈中取出下一条，不需要额外的内存
 void cJSON_Delete(cJSON *c)
 {
 	cJSON *next;
-	while (c)
+    cJSON *pending = 0;
+	while (c || pending)
 	{
+        if (!c)
+        {
+            c = pending;
+            pending = pending->prev;
+        }
         //通过while循环释放同一层结点的动态内存
 		next=c->next; 
 		// cJSON_IsReference = 0001 0000 0000,下面的类型按位与均为0
-        // 如果当前结点的child成员不为0，说明存在下一层结构（type为object或array），这个时候递归的进入下一层，逐层释放
+        // 如果当前结点的child成员不为0，说明存在下一层结构（type为object或array），这个时候进入下一层，逐层释放
 		if (!(c->type&cJSON_IsReference) && c->child){
-            cJSON_Delete(c->child);
+            // 子结点链表还被其它容器共享（cJSON_DuplicateShared）时只减少共享计数，最后一个拥有者才释放
+            if (share_release(c->child))
+            {
+                if (next)
+                {
+                    next->prev = pending;
+                    pending = next;
+                }
+                next = c->child;
+            }
         }
         // 释放存储“值”的内容的动态内存
-		if (!(c->type&cJSON_IsReference) && c->valuestring){
-             cJSON_free(c->valuestring);
+		if (!(c->type&cJSON_IsReference) && node_valuestring(c)){
+             node_free_string(c,c->valuestring);
         }
         //释放存储“键”的内容的动态内存
 		if (!(c->type&cJSON_StringIsConst) && c->string){
-             cJSON_free(c->string);
+             node_free_string(c,c->string);
+        }
+        // 映射区域中的字符串不会再被访问（它们不属于结点，不会被释放），所以可以在子结点之前释放映射
+        if (c->type&cJSON_OwnsMapping)
+        {
+            unmap_file(((cJSON_Mapped*)c)->map,((cJSON_Mapped*)c)->maplen);
         }
         //释放cJSON结构体的动态内存
-		cJSON_free(c);
+		mem_free(c,(c->type&cJSON_OwnsMapping) ? sizeof(cJSON_Mapped) : sizeof(cJSON),MEM_NODE);
 		c=next;
 	}
 }
 
+// 统计一个结点本身和它拥有的字符串占用的内存
+static size_t node_usage(const cJSON* c){
+    size_t size = sizeof(cJSON);
+    const char* str = node_valuestring(c);
+    if (c->type & cJSON_OwnsMapping)
+    {
+        size = sizeof(cJSON_Mapped) + ((const cJSON_Mapped*)c)->maplen;
+    }
+#ifdef CJSON_COMPACT
+    if (str && cJSON_IsInline(c,str))
+    {
+        str = 0;
+    }
+#endif
+    if (str && !(c->type & cJSON_IsReference))
+    {
+        size += strlen(str) + 1;
+    }
+    str = c->string;
+#ifdef CJSON_COMPACT
+    if (str && cJSON_IsInline(c,str))
+    {
+        str = 0;
+    }
+#endif
+    if (str && !(c->type & cJSON_StringIsConst))
+    {
+        size += strlen(str) + 1;
+    }
+    return size;
+}
+
+// 树占用的内存，用显式的栈保存还没有统计的子结点链表，深层的树也不会递归；申请不到栈的内存时返回0
+size_t cJSON_MemoryUsage(const cJSON* item){
+    const cJSON* local[32];
+    const cJSON** stack = local;
+    const cJSON** newstack;
+    size_t capacity = sizeof(local) / sizeof(local[0]);
+    size_t depth = 0;
+    size_t total;
+    const cJSON* c;
+    if (!item)
+    {
+        return 0;
+    }
+    total = node_usage(item);
+    if (item->child && !(item->type & cJSON_IsReference))
+    {
+        stack[depth++] = item->child;
+    }
+    while (depth)
+    {
+        for (c = stack[--depth];c;c = c->next)
+        {
+            total += node_usage(c);
+            if (!c->child || (c->type & cJSON_IsReference))
+            {
+                continue;
+            }
+            if (depth == capacity)
+            {
+                newstack = (const cJSON**)mem_alloc(capacity * 2 * sizeof(cJSON*),MEM_OTHER);
+                if (!newstack)
+                {
+                    total = 0;
+                    break;
+                }
+                memcpy(newstack,stack,depth * sizeof(cJSON*));
+                if (stack != local)
+                {
+                    mem_free((void*)stack,capacity * sizeof(cJSON*),MEM_OTHER);
+                }
+                stack = newstack;
+                capacity *= 2;
+            }
+            stack[depth++] = c->child;
+        }
+        if (!total)
+        {
+            break;
+        }
+    }
+    if (stack != local)
+    {
+        mem_free((void*)stack,capacity * sizeof(cJSON*),MEM_OTHER);
+    }
+    return total;
+}
+
+// 延迟释放：请求线程只把整棵树压入无锁栈，由后台线程调用cJSON_Delete
+// 栈用根结点的prev成员串起来（cJSON_Delete本来就不读prev），压栈是一次CAS，取栈是一次交换
+#if !defined(_WIN32) && defined(__GNUC__)
+#define CJSON_HAVE_RECLAIMER
+#endif
+
+#ifdef CJSON_HAVE_RECLAIMER
+// glibc只在_GNU_SOURCE下声明SCHED_IDLE，取值是Linux内核ABI的一部分；用自己的名字，不重新定义C库的宏
+#if defined(SCHED_IDLE)
+#define CJSON_SCHED_IDLE SCHED_IDLE
+#elif defined(__linux__)
+#define CJSON_SCHED_IDLE 5
+#endif
+
+static cJSON* reclaim_head;
+static int reclaim_running;
+static int reclaim_stopping;
+static sem_t reclaim_sem;
+static pthread_t reclaim_thread;
+
+static void* reclaim_main(void* arg){
+    cJSON* c;
+    cJSON* next;
+    (void)arg;
+#ifdef CJSON_SCHED_IDLE
+    {
+        // 只用空闲的CPU时间释放内存，不抢占请求线程；CPU一直跑满时可能长时间得不到运行，队列中的树会越积越多
+        struct sched_param param;
+        memset(&param,0,sizeof(param));
+        pthread_setschedparam(pthread_self(),CJSON_SCHED_IDLE,&param);
+    }
+#endif
+    for (;;)
+    {
+        while (sem_wait(&reclaim_sem) && errno == EINTR);
+        c = __atomic_exchange_n(&reclaim_head,(cJSON*)0,__ATOMIC_ACQUIRE);
+        while (c)
+        {
+            next = c->prev;
+            cJSON_Delete(c);
+            c = next;
+        }
+        // 停止前压入的树都已经取走：cJSON_StopReclaimer在置位之前已经停止了新的压栈
+        if (__atomic_load_n(&reclaim_stopping,__ATOMIC_ACQUIRE) && !__atomic_load_n(&reclaim_head,__ATOMIC_ACQUIRE))
+        {
+            return 0;
+        }
+    }
+}
+#endif
+
+int cJSON_StartReclaimer(void){
+#ifdef CJSON_HAVE_RECLAIMER
+    if (reclaim_running)
+    {
+        return 1;
+    }
+    if (sem_init(&reclaim_sem,0,0))
+    {
+        return 0;
+    }
+    reclaim_stopping = 0;
+    if (pthread_create(&reclaim_thread,0,reclaim_main,0))
+    {
+        sem_destroy(&reclaim_sem);
+        return 0;
+    }
+    __atomic_store_n(&reclaim_running,1,__ATOMIC_RELEASE);
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void cJSON_StopReclaimer(void){
+#ifdef CJSON_HAVE_RECLAIMER
+    if (!reclaim_running)
+    {
+        return;
+    }
+    __atomic_store_n(&reclaim_running,0,__ATOMIC_RELEASE);
+    __atomic_store_n(&reclaim_stopping,1,__ATOMIC_RELEASE);
+    sem_post(&reclaim_sem);
+    pthread_join(reclaim_thread,0);
+    sem_destroy(&reclaim_sem);
+#endif
+}
+
+void cJSON_DeleteDeferred(cJSON* c){
+#ifdef CJSON_HAVE_RECLAIMER
+    cJSON* head;
+    if (!c)
+    {
+        return;
+    }
+    if (__atomic_load_n(&reclaim_running,__ATOMIC_ACQUIRE))
+    {
+        head = __atomic_load_n(&reclaim_head,__ATOMIC_RELAXED);
+        do
+        {
+            c->prev = head;
+        } while (!__atomic_compare_exchange_n(&reclaim_head,&head,c,1,__ATOMIC_RELEASE,__ATOMIC_RELAXED));
+        // 栈原来不空时后台线程还没有取走它，不需要再唤醒
+        if (!head)
+        {
+            sem_post(&reclaim_sem);
+        }
+        return;
+    }
+#endif
+    cJSON_Delete(c);
+}
+
 //全局变量，ep指向了出错的字符串，当需要获得出错的字符串的时候，可通过调用函数cJSON_GetErrorPtr()查看
 //未初始化全局不可修改指定内存内容的指针,全局常量字符串，内容不可改变，但是指针指向的位置可以改变，间接改变存储的内容
 static const char* ep;
@@ -966,88 +1774,299 @@ const char* cJSON_GetErrorPtr(void){
     return ep;
 }
 
-/* Parse the input text into an unescaped cstring, and populate item. */
-static const unsigned char firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
+/* 字符串的校验：UTF-8、转义和代理对 */
 
-// 编码格式转换
-static unsigned parse_hex4(const char* str){
-    unsigned h = 0;
-    if (*str >= '0' && *str <= '9')
+// 十六进制数字的值，不是十六进制数字时返回-1
+static int hex_digit(unsigned char c){
+    if (c >= '0' && c <= '9')
     {
-        h += (*str) - '0';
-    }else if (*str >= 'A' && *str <= 'F')
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
     {
-        h += 10 + (*str) - 'A';
-    }else if (*str >= 'a' && *str <= 'f')
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// p处4个十六进制数字的值，数字不够或者不是十六进制数字时返回-1
+static long validate_hex4(const unsigned char* p,const unsigned char* end){
+    long h = 0;
+    int d;
+    int i;
+    if (end - p < 4)
     {
-        h += 10 + (*str) - 'a';
-    }else{
-        return 0;
+        return -1;
     }
-    h = h << 4;
-    str++;
-    if (*str >= '0' && *str <= '9')
+    for (i = 0;i < 4;i++)
     {
-        h += (*str) - '0';
-    }else if (*str >= 'A' && *str <= 'F')
+        d = hex_digit(p[i]);
+        if (d < 0)
+        {
+            return -1;
+        }
+        h = (h << 4) | d;
+    }
+    return h;
+}
+
+// p处一个UTF-8字符的长度（RFC 3629）：过长的编码、代理区的码点、超过U+10FFFF、被截断或者后续字节不对时返回0
+static int utf8_length(const unsigned char* p,const unsigned char* end){
+    unsigned char lo = 0x80,hi = 0xBF;
+    int n;
+    int i;
+    if (*p < 0x80)
     {
-        h += 10 + (*str) - 'A';
-    }else if (*str >= 'a' && *str <= 'f')
+        return 1;
+    }
+    if (*p < 0xC2)
     {
-        h += 10 + (*str) - 'a';
-    }else{
         return 0;
-    }
-    h = h << 4;
-    str++;
-    if (*str >= '0' && *str <= '9')
+    }else if (*p < 0xE0)
     {
-        h += (*str) - '0';
-    }else if (*str >= 'A' && *str <= 'F')
+        n = 2;
+    }else if (*p < 0xF0)
     {
-        h += 10 + (*str) - 'A';
-    }else if (*str >= 'a' && *str <= 'f')
+        n = 3;
+        // E0后面小于A0是过长编码，ED后面大于9F是代理区
+        if (*p == 0xE0)
+        {
+            lo = 0xA0;
+        }else if (*p == 0xED)
+        {
+            hi = 0x9F;
+        }
+    }else if (*p < 0xF5)
     {
-        h += 10 + (*str) - 'a';
+        n = 4;
+        // F0后面小于90是过长编码，F4后面大于8F超过U+10FFFF
+        if (*p == 0xF0)
+        {
+            lo = 0x90;
+        }else if (*p == 0xF4)
+        {
+            hi = 0x8F;
+        }
     }else{
         return 0;
     }
-    return h;
-}
-
-// 解析字符串类型
-static const char* parse_string(cJSON* item,const char* str){
-    // 跳过开头的'\"'字符
-    const char *ptr = str + 1;
-    char *ptr2;
-    char *out;
-    int len = 0;
-    unsigned uc,uc2;
-
-    // 传入的不是字符串则出错，ep指向出错内容。
-    if (*str!= '\"')
+    if (end - p < n || p[1] < lo || p[1] > hi)
     {
-        ep = str;
         return 0;
     }
-    //假设传入的字符串为这个"\"Jack (\\\"Bee\\\") Nimble\", \n\"format\""，
-	//这段代码能够统计出jack(\"Bee\")Nimble的长度，方便接下来为存储这段字符申请内存，注意\\该表字符\,\"代表字符"
-    while (*ptr != '\"' && *ptr && ++len)
+    for (i = 2;i < n;i++)
     {
-        // 一次跳过两个字符，因为默认\\和\"是一起出现的
-        if (*ptr++ == '\\')
+        if ((p[i] & 0xC0) != 0x80)
         {
-            ptr++;
+            return 0;
         }
     }
-    // 多申请一个内容存储结尾字符'\0'
-    out = (char*)cJSON_malloc(len + 1);
-    if (!out)
+    return n;
+}
+
+#ifdef CJSON_SSE2
+// v和上一块prev拼起来向后错开n个字节（n为1到3）：第i个字节是原文中v的第i-n个字节
+#define bytes_prev(v,prev,n) _mm_or_si128(_mm_slli_si128(v,n),_mm_srli_si128(prev,16 - (n)))
+// 逐字节无符号比较a >= b
+#define bytes_ge(a,b) _mm_cmpeq_epi8(_mm_max_epu8(a,b),a)
+
+// 16个字节的UTF-8检查，按Keiser和Lemire的思路不逐个字符解码，而是把每个字节和它前面的1到3个字节一起判断；
+// 他们用pshufb查表，这里只用SSE2的比较。prev是紧挨在前面的16个字节，跨两块的字符也能查出来。
+// 返回出错字节的位图，不为0时只说明有错，出错的位置由调用者逐个字符找出来
+static unsigned utf8_check(__m128i v,__m128i prev){
+    __m128i prev1 = bytes_prev(v,prev,1);
+    __m128i prev2 = bytes_prev(v,prev,2);
+    __m128i prev3 = bytes_prev(v,prev,3);
+    // 后续字节10xxxxxx按有符号数比较就是小于(char)0xC0；前面1到3个字节中有首字节时这里必须是后续字节，反过来也一样
+    __m128i cont = _mm_cmplt_epi8(v,_mm_set1_epi8((char)0xC0));
+    __m128i need = _mm_or_si128(_mm_or_si128(bytes_ge(prev1,_mm_set1_epi8((char)0xC0)),bytes_ge(prev2,_mm_set1_epi8((char)0xE0))),
+        bytes_ge(prev3,_mm_set1_epi8((char)0xF0)));
+    __m128i err = _mm_xor_si128(cont,need);
+    __m128i a0 = bytes_ge(v,_mm_set1_epi8((char)0xA0));
+    __m128i b90 = bytes_ge(v,_mm_set1_epi8((char)0x90));
+    // C0、C1只能是过长编码，F5以上不是首字节
+    err = _mm_or_si128(err,_mm_cmpeq_epi8(_mm_and_si128(v,_mm_set1_epi8((char)0xFE)),_mm_set1_epi8((char)0xC0)));
+    err = _mm_or_si128(err,bytes_ge(v,_mm_set1_epi8((char)0xF5)));
+    // 第二个字节的范围：E0之后小于A0、F0之后小于90是过长编码，ED之后大于9F是代理区，F4之后大于8F超过U+10FFFF
+    err = _mm_or_si128(err,_mm_andnot_si128(a0,_mm_cmpeq_epi8(prev1,_mm_set1_epi8((char)0xE0))));
+    err = _mm_or_si128(err,_mm_and_si128(a0,_mm_cmpeq_epi8(prev1,_mm_set1_epi8((char)0xED))));
+    err = _mm_or_si128(err,_mm_andnot_si128(b90,_mm_cmpeq_epi8(prev1,_mm_set1_epi8((char)0xF0))));
+    err = _mm_or_si128(err,_mm_and_si128(b90,_mm_cmpeq_epi8(prev1,_mm_set1_epi8((char)0xF4))));
+    return (unsigned)_mm_movemask_epi8(err);
+}
+
+// 从ones + 16 - k开始的16个字节中前k个为0xFF，其余为0
+static const unsigned char ones[32] = {
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+};
+
+// 一次看16个字节，越过普通字符，返回第一个引号、反斜杠或控制字符的位置；UTF-8有错时返回0，由调用者逐个字符找出位置。
+// 不足16个字节时复制到补0的缓冲区，补的0算作控制字符，这时返回的位置可能超过end
+static const unsigned char* scan_string(const unsigned char* p,const unsigned char* end){
+    unsigned char tail[16];
+    __m128i limit = _mm_set1_epi8(31);
+    __m128i q = _mm_set1_epi8('"');
+    __m128i b = _mm_set1_epi8('\\');
+    __m128i prev = _mm_setzero_si128();
+    __m128i v;
+    unsigned special;
+    unsigned high;
+    int k;
+    for (;;)
     {
-        return 0;
+        if (end - p >= 16)
+        {
+            v = _mm_loadu_si128((const __m128i*)p);
+        }else{
+            memset(tail,0,sizeof(tail));
+            memcpy(tail,p,end - p);
+            v = _mm_loadu_si128((const __m128i*)tail);
+        }
+        special = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v,q),_mm_cmpeq_epi8(v,b)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v,limit),limit)));
+        k = special ? lowest_bit(special) : 16;
+        high = (unsigned)_mm_movemask_epi8(v) & ((1u << k) - 1);
+        // 这一块和上一块末尾都是ASCII时不用检查UTF-8
+        if (high | (unsigned)_mm_movemask_epi8(prev))
+        {
+            // 引号之后的字节不属于这个字符串，换成0，没写完的字符就会在这里查出来
+            v = _mm_and_si128(v,_mm_loadu_si128((const __m128i*)(ones + 16 - k)));
+            if (utf8_check(v,prev))
+            {
+                return 0;
+            }
+            prev = v;
+        }else{
+            prev = _mm_setzero_si128();
+        }
+        if (special)
+        {
+            return p + k;
+        }
+        p += 16;
     }
-    
-    ptr = str + 1;
+}
+#endif
+
+// 校验p处的字符串（p指向开头的引号），返回结束的引号之后的位置；出错时ep指向出错的字节，返回0
+// 转义只允许RFC 8259中的几种，\u表示的代理区码点必须成对出现；控制字符必须转义，其他字节必须是合法的UTF-8。
+// nul为0时也不接受\u0000：解析出的字符串以'\0'结尾，放不下这个字符
+static const unsigned char* validate_string(const unsigned char* p,const unsigned char* end,int nul){
+#ifdef CJSON_SSE2
+    const unsigned char* next;
+    int fast = 1;
+#endif
+    long uc;
+    int n;
+    p++;
+    for (;;)
+    {
+#ifdef CJSON_SSE2
+        // UTF-8有错时从这一段的开头逐个字符检查，找出出错的位置；这个字符串剩下的部分都逐个字符检查，
+        // 否则每前进一个字符又从那里向量化地扫描一遍，长字符串末尾出错时是平方的
+        if (fast)
+        {
+            next = scan_string(p,end);
+            if (next)
+            {
+                p = next < end ? next : end;
+            }else{
+                fast = 0;
+            }
+        }
+#endif
+        while (p < end && *p >= 0x20 && *p < 0x80 && *p != '"' && *p != '\\')
+        {
+            p++;
+        }
+        if (p == end || *p < 0x20)
+        {
+            ep = (const char*)p;
+            return 0;
+        }
+        if (*p == '"')
+        {
+            return p + 1;
+        }
+        if (*p >= 0x80)
+        {
+            n = utf8_length(p,end);
+            if (!n)
+            {
+                ep = (const char*)p;
+                return 0;
+            }
+            p += n;
+            continue;
+        }
+        // 转义序列
+        p++;
+        if (p == end)
+        {
+            ep = (const char*)p;
+            return 0;
+        }
+        switch (*p)
+        {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+            p++;
+            break;
+        case 'u':
+            uc = validate_hex4(p + 1,end);
+            if (uc < 0 || (uc >= 0xDC00 && uc <= 0xDFFF) || (!uc && !nul))
+            {
+                ep = (const char*)p - 1;
+                return 0;
+            }
+            p += 5;
+            if (uc >= 0xD800 && uc <= 0xDBFF)
+            {
+                // 高位代理后面必须紧跟\u表示的低位代理
+                if (end - p < 2 || p[0] != '\\' || p[1] != 'u')
+                {
+                    ep = (const char*)p - 6;
+                    return 0;
+                }
+                uc = validate_hex4(p + 2,end);
+                if (uc < 0xDC00 || uc > 0xDFFF)
+                {
+                    ep = (const char*)p;
+                    return 0;
+                }
+                p += 6;
+            }
+            break;
+        default:
+            ep = (const char*)p - 1;
+            return 0;
+        }
+    }
+}
+
+/* Parse the input text into an unescaped cstring, and populate item. */
+static const unsigned char firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
+
+// 编码格式转换：4个十六进制数字的值，不是4个十六进制数字时返回0（遇到'\0'就停下，不会越过文本结尾）
+static unsigned parse_hex4(const char* str){
+    long h = validate_hex4((const unsigned char*)str,(const unsigned char*)str + 4);
+    return h < 0 ? 0 : (unsigned)h;
+}
+
+// 解析字符串类型
+// 把ptr（开头的引号之后）中的字符串解码到out，写入结尾的'\0'，返回结尾引号之后的位置，*end指向写入的'\0'
+// out可以就是ptr（原地解析），转义序列解码后只会变短
+static const char* decode_string(const char* ptr,char* out,char** end){
+    char *ptr2;
+    int len;
+    unsigned uc,uc2;
     //ptr2指向out，通过改变ptr2中的内容，改变out中的内容
     ptr2 = out;
     while (*ptr != '\"' && * ptr)
@@ -1059,6 +2078,11 @@ static const char* parse_string(cJSON* item,const char* str){
         }else{
             // 先多移动一个字符，在开始存储
             ptr++;
+            // 反斜杠后面就是文本结尾时停下，不能越过'\0'
+            if (!*ptr)
+            {
+                break;
+            }
             // 存储特殊字符
             switch (*ptr)
             {
@@ -1084,24 +2108,31 @@ static const char* parse_string(cJSON* item,const char* str){
             
             case 'u':
                 //这里主要是编码转换的，了解一下就好
+                // 不严格检查时不合法的\u照旧丢掉：不是4个十六进制数字时按普通字符复制u，
+                // \u0000和单独的代理跳过这6个字符，高位代理后面不是低位代理时只丢掉高位代理
                 uc = parse_hex4(ptr + 1);
+                if (!uc && (ptr[1] != '0' || ptr[2] != '0' || ptr[3] != '0' || ptr[4] != '0'))
+                {
+                    *ptr2++ = *ptr;
+                    break;
+                }
                 ptr += 4;
                 if ((uc >= 0xDC00 && uc <= 0xDFFF) || uc == 0)
                 {
                     break;
                 }
-                if (uc >= 0xDB800 && uc <= 0xDBFF)
+                if (uc >= 0xD800 && uc <= 0xDBFF)
                 {
                     if (ptr[1] != '\\' || ptr[2] != 'u')
                     {
                         break;
                     }
                     uc2 = parse_hex4(ptr + 3);
-                    ptr += 6;
                     if (uc2 < 0xDC00 || uc2 > 0xDFFF)
                     {
                         break;
                     }
+                    ptr += 6;
                     uc = 0x10000 + (((uc & 0x3FF) << 10) | (uc2 & 0x3FF));
                 }
                 len = 4;
@@ -1117,18 +2148,21 @@ static const char* parse_string(cJSON* item,const char* str){
                 }
                 ptr2 += len;
                 
+                // 从最后一个字节往前写，每个case写一个字节后落到下一个case
                 switch (len)
                 {
                 case 4:
                     *--ptr2 = ((uc | 0x80) & 0xBF);
                     uc >>= 6;
-                    break;
+                    /* fall through */
                 case 3:
                     *--ptr2 = ((uc | 0x80) & 0xBF);
                     uc >>= 6;
+                    /* fall through */
                 case 2:
                     *--ptr2 = ((uc | 0x80) & 0xBF);
                     uc >>= 6;
+                    /* fall through */
                 case 1:
                     *--ptr2 = (uc | firstByteMark[len]);
                 }
@@ -1143,58 +2177,186 @@ static const char* parse_string(cJSON* item,const char* str){
             ptr++;
         }
     }
-    *ptr2 = 0;
+    // 先越过结尾的引号再写'\0'，原地解析时ptr2可能正好指向这个引号
     if (*ptr == '\"')
     {
         ptr++;
     }
-    // 设置item
-    item->valuestring = out;
-    item->type = cJSON_String;
-    // 返回剩余的字符串
+    *ptr2 = 0;
+    *end = ptr2;
     return ptr;
 }
 
-
-static const char* parse_number(cJSON* item,const char* num){
-    // sign是符号位，signsubscale是科学计数法中的符号，如 10e-10，10e+10
-    double n = 0,sign = 1,scale = 0;
-    int subscale = 0,signsubscale = 1;
-    //记录负号
-    if (*num == '-')
+// 统计从ptr（开头的引号之后）到结尾引号之间的字符数，转义序列按解码前的长度计算，是解码后长度的上限
+static int string_length(const char* ptr){
+    int len = 0;
+    //假设传入的字符串为这个"\"Jack (\\\"Bee\\\") Nimble\", \n\"format\""，
+    //这段代码能够统计出jack(\"Bee\")Nimble的长度，方便接下来为存储这段字符申请内存，注意\\该表字符\,\"代表字符"
+    while (*ptr != '\"' && *ptr && ++len)
     {
-        sign = -1;
-        num++;
+        // 一次跳过两个字符，因为默认\\和\"是一起出现的；反斜杠在文本结尾时不越过'\0'
+        if (*ptr++ == '\\' && *ptr)
+        {
+            ptr++;
+        }
     }
-    //0的话直接移动，比如00001直接打印1就行
-    if (*num == '0')
+    return len;
+}
+
+static const char* parse_string(cJSON* item,const char* str,parse_context* ctx){
+    const char *ptr;
+    char *ptr2;
+    char *out;
+    int len = 0;
+
+    // 传入的不是字符串则出错，ep指向出错内容。
+    if (*str!= '\"')
     {
-        num++;
+        ep = str;
+        return 0;
     }
-    // 数字式1到9的话，得到其对应的值
-    if (*num >= '1' && *num <= '9')
+    if (ctx->strict)
     {
-        do
+        // 严格检查：先校验整个字符串，校验时已经找到了结尾的引号，原文的长度就是解码后长度的上限
+        ptr = (const char*)validate_string((const unsigned char*)str,(const unsigned char*)ctx->end,0);
+        if (!ptr)
         {
-            n = (n * 10.0) + (*num++ - '0');
-        } while (*num >= '0' && *num <= '9');
+            return 0;
+        }
+        len = (int)(ptr - str - 2);
     }
-    //说明带有小数
-    if (*num == '.' && num[1] >= '0' && num[1] <= '9')
+    if (ctx->insitu)
     {
-        num++;
-        do
+        // 原地解析：转义序列解码后只会变短，所以直接写回引号之后的位置，不需要统计长度和申请内存
+        out = (char*)str + 1;
+    }else{
+        if (!ctx->strict)
         {
-            n = (n * 10.0) + (*num++ - '0');
-            // 后面调整小数点的位置
-            scale--;
-        } while (*num >= '0' && *num <= '9');
+            len = string_length(str + 1);
+        }
+        // 多申请一个内容存储结尾字符'\0'，解析值的时候item->string是已经解析好的键
+        out = node_alloc_string(item,item->string,len + 1);
+        if (!out)
+        {
+            return 0;
+        }
     }
-    //科计数法的部分
-    if (*num == 'e' || *num == 'E')
+    ptr = decode_string(str + 1,out,&ptr2);
+    // 转义字符解码后变短，统计只计入实际写入的字节
+    if (!ctx->insitu && mem_stats)
     {
-        num++;
-        if (*num == '+')
+#ifdef CJSON_COMPACT
+        if (!cJSON_IsInline(item,out))
+#endif
+        mem_account(MEM_STRING,len + 1,ptr2 - out + 1);
+    }
+    // 设置item，原地解析的字符串属于输入缓冲区，用cJSON_IsReference标记，cJSON_Delete不会释放它
+    item->valuestring = out;
+    item->type = ctx->insitu ? (cJSON_String | cJSON_IsReference) : cJSON_String;
+    // 返回剩余的字符串
+    return ptr;
+}
+
+
+// 10的0到22次方都能用double精确表示
+static const double exact_pow10[23] = {
+    1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22
+};
+
+// 把[start,end)之间的数字交给strtod，得到正确舍入的结果。strtod按当前locale识别小数点，所以复制一份并换成locale的小数点
+static double number_strtod(const char* start,const char* end){
+    char local[64];
+    char* buf = local;
+    char point = localeconv()->decimal_point[0];
+    size_t len = (size_t)(end - start);
+    size_t i;
+    double n;
+    if (len >= sizeof(local))
+    {
+        buf = (char*)mem_alloc(len + 1,MEM_OTHER);
+        if (!buf)
+        {
+            return 0;
+        }
+    }
+    memcpy(buf,start,len);
+    buf[len] = 0;
+    for (i = 0;i < len && point != '.';i++)
+    {
+        if (buf[i] == '.')
+        {
+            buf[i] = point;
+        }
+    }
+    n = strtod(buf,0);
+    if (buf != local)
+    {
+        mem_free(buf,len + 1,MEM_OTHER);
+    }
+    return n;
+}
+
+// 解析数字，结果是最接近原文的double（正确舍入）
+static const char* parse_number(cJSON* item,const char* num){
+    const char* start = num;
+    // m是前19位有效数字，digits是其中的位数，dropped表示后面还有没放进m的非0数字
+    unsigned long long m = 0;
+    int digits = 0,dropped = 0;
+    // 数值是m * 10^exp10，exponent是e后面的指数
+    int exp10 = 0,exponent = 0,signsubscale = 1,bigexp = 0;
+    int neg = 0;
+    double n;
+    //记录负号
+    if (*num == '-')
+    {
+        neg = 1;
+        num++;
+    }
+    //0的话直接移动，比如00001直接打印1就行
+    if (*num == '0')
+    {
+        num++;
+    }
+    // 数字式1到9的话，得到其对应的值；超过19位的数字只影响指数
+    if (*num >= '1' && *num <= '9')
+    {
+        do
+        {
+            if (digits < 19)
+            {
+                m = m * 10 + (unsigned)(*num - '0');
+                digits++;
+            }else{
+                dropped |= (*num != '0');
+                exp10++;
+            }
+            num++;
+        } while (*num >= '0' && *num <= '9');
+    }
+    //说明带有小数
+    if (*num == '.' && num[1] >= '0' && num[1] <= '9')
+    {
+        num++;
+        do
+        {
+            if (digits < 19)
+            {
+                // 整数部分是0时小数点后开头的0不算有效数字
+                m = m * 10 + (unsigned)(*num - '0');
+                digits += (m != 0);
+                // 后面调整小数点的位置
+                exp10--;
+            }else{
+                dropped |= (*num != '0');
+            }
+            num++;
+        } while (*num >= '0' && *num <= '9');
+    }
+    //科计数法的部分
+    if (*num == 'e' || *num == 'E')
+    {
+        num++;
+        if (*num == '+')
         {
             num++;
         //e后面为-号
@@ -1205,11 +2367,29 @@ static const char* parse_number(cJSON* item,const char* num){
         }
         while (*num >= '0' && *num <= '9')
         {
-            subscale = (subscale * 10) + (*num++ - '0');
+            // 很大的指数交给strtod处理上溢和下溢
+            if (exponent < 100000)
+            {
+                exponent = (exponent * 10) + (*num - '0');
+            }else{
+                bigexp = 1;
+            }
+            num++;
         }
     }
-    //得到n的结果
-    n = sign * n * pow(10.0,(scale + subscale * signsubscale));
+    exp10 += exponent * signsubscale;
+    if (m == 0)
+    {
+        // 有效数字全是0
+        n = 0;
+    }else if (!dropped && !bigexp && digits <= 15 && exp10 >= -22 && exp10 <= 22)
+    {
+        // 不超过15位的有效数字和10的0到22次方都是精确的double，一次乘除只舍入一次，结果就是正确舍入的
+        n = (exp10 < 0) ? (double)m / exact_pow10[-exp10] : (double)m * exact_pow10[exp10];
+    }else{
+        n = fabs(number_strtod(start,num));
+    }
+    n = neg ? -n : n;
     //存储到指定的位置
     item->valuedouble = n;
     item->valuedoint = (int)n;
@@ -1218,8 +2398,18 @@ static const char* parse_number(cJSON* item,const char* num){
     return num;
 }
 
-// 将字符串存储到指定的item成员里面
-static const char* parse_value(cJSON* item,const char* value){
+// 跳过一个字符串中开头包含ASCII码<=32的字符，空格字符也会被跳过
+static const char* skip(const char* in){
+    // 字符指针存在，当前字符不是'\0'，且<= 32;
+    while (in && *in && (unsigned char)*in <= 32)
+    {
+        in++;
+    }
+    return in;
+}
+
+// 解析一个不是数组和对象的值，存储到item中
+static const char* parse_scalar(cJSON* item,const char* value,parse_context* ctx){
     if (!value)
     {
         return 0;
@@ -1252,192 +2442,252 @@ static const char* parse_value(cJSON* item,const char* value){
     // 字符串开始标识符，则调用此函数
     if (*value == '\"')
     {
-        return parse_string(item,value);
+        return parse_string(item,value,ctx);
     }
     // 数值开始标识符则调用此函数
     if (*value == '-' || (*value >= '0' && *value <= '9'))
     {
         return parse_number(item,value);
     }
-    //array开始标识符则调用此函数
-    if (*value == '[')
-    {
-        return parse_array(item,value);
-    }
-    // object开始标识符则调用此函数 
-    if (*value == '{')
-    {
-        return parse_object(item,value);
-    }
     //都不匹配，则出错，ep指向这段字符串，返回0
     ep = value;
     return 0;
 }
 
 
-// 跳过一个字符串中开头包含ASCII码<=32的字符，空格字符也会被跳过
-static const char* skip(const char* in){
-    // 字符指针存在，当前字符不是'\0'，且<= 32;
-    while (in && *in && (unsigned char)*in <= 32)
-    {
-        in++;
-    }
-    return in;
-}
-
-static const char* parse_array(cJSON* item,const char* value){
-    cJSON* child;
-    //出错，指向出错的位置
-    if (*value != '[')
-    {
-        ep = value;
-        return 0;
-    }
-    // 设置item的类型
-    item->type = cJSON_Array;
-    // value + 1跳过 [,skip跳过开头ASCII<=32的字符
-    value = skip(value + 1);
-    // 说明是空的array
-    if (*value == ']')
-    {
-        return value + 1;
-    }
-    // array和第一个结点之间通过child进行连接
-    item->child = child = cJSON_New_Item();
-    // 内存分配失败
-    if (!item->child)
-    {
-        return 0;
-    }
-    //进行递归调用，处理array中的第一个结点
-    value = skip(parse_value(child,skip(value)));
-    // 如果value没有后续了，则解析结束
-    if (!value)
-    {
-        return 0;
-    }
-    // []中的字符串以,号隔开，故每处理一个结点，接下来的字符都是逗号
-    while (*value == ',')
+// 解析对象的键，存放到item->string
+static const char* parse_key(cJSON* item,const char* str,parse_context* ctx){
+    const char* ptr = str + 1;
+    char* key;
+    if (ctx->pool && *str == '\"')
     {
-        cJSON* new_item;
-        // 内存分配失败
-        if (!(new_item = cJSON_New_Item()))
+        if (ctx->strict && !validate_string((const unsigned char*)str,(const unsigned char*)ctx->end,0))
         {
             return 0;
         }
-        child->next = new_item;
-        //将同一级结点之间使用next和prev指针串起来，并且指向下一个结构继续处理
-        new_item->prev = child;
-        child = new_item;
-        //递归的构建array中的每个结点
-        value = skip(parse_value(child,skip(value + 1)));
-        // 如果value没有后续了，则解析结束
-        if (!value)
+        // 没有转义字符的键直接用原文在池中查找，不需要先解码到新申请的内存里
+        while (*ptr != '\"' && *ptr != '\\' && *ptr)
         {
-            return 0;
+            ptr++;
+        }
+        if (*ptr == '\"')
+        {
+            item->string = intern_string(ctx->pool,str + 1,(size_t)(ptr - str - 1));
+            return item->string ? ptr + 1 : 0;
         }
     }
-    // 遇到array结尾标志，向下移动
-    if (*value == ']')
-    {
-        return value + 1;
-    }
-    // 如果不是正确的结尾标志，则说明出错，ep指向错误字符，并且解析结束
-    ep = value;
-    return 0;
-}
-
-// 处理*value为'{'的情况
-static const char* parse_object(cJSON* item,const char* value){
-    cJSON *child;
-    // 出错的话，打印出错位置
-    if (*value != '{')
+    ptr = parse_string(item,str,ctx);
+    if (!ptr)
     {
-        ep = value;
         return 0;
     }
-    // 设置item的类型
-    item->type = cJSON_Object;
-    // 向下移动一格，并且跳过开头ASCII<=32的字符
-    value = skip(value + 1);
-    //空字符，指向下一个
-    if (*value == '}')
-    {
-        return value + 1;
-    }
-    // 申请内存，object中的第一个结点
-    item->child = child = cJSON_New_Item();
-    if (!item->child)
+    //将值中的内容赋值给对应的键
+    key = item->valuestring;
+    item->valuestring = 0;
+    if (ctx->pool)
     {
-        return 0;
+        // 带转义字符的键解码后再放入池中
+        item->string = intern_string(ctx->pool,key,strlen(key));
+        node_free_string(item,key);
+        return item->string ? ptr : 0;
     }
-    // 处理第一个结点
-    value = skip(parse_string(child,skip(value)));
+    item->string = key;
+    return ptr;
+}
+
+// 解析对象成员的键和后面的':'，返回值的开始位置
+// keyflag为cJSON_StringIsConst时键不属于结点，要马上标记，这样中途出错时cJSON_Delete也不会释放它
+static const char* parse_member_key(cJSON* item,const char* value,parse_context* ctx,int keyflag){
+    value = skip(parse_key(item,value,ctx));
+    item->type |= keyflag;
     if (!value)
     {
         return 0;
     }
-    //将值中的内容赋值给对应的键
-    child->string = child->valuestring;
-    child->valuestring = 0;
     // 键和值之间通过:号连接。
     if (*value != ':')
     {
         ep = value;
         return 0;
     }
-    //递归调用函数向下处理，用来添加值
-    value = skip(parse_value(child,skip(value + 1)));
+    return skip(value + 1);
+}
+
+// 解析一个值到item中，数组和对象会一直解析到与之匹配的结束符
+// 不使用递归：每进入一层非空的数组或对象，就把容器结点压入自己维护的栈，子结点解析完后再从栈中取回，
+// 所以嵌套层数不受线程栈大小的限制；超过nesting_limit时在超出的位置立即失败
+static const char* parse_value(cJSON* item,const char* value,parse_context* ctx){
+    cJSON* local[PARSE_STACK_SIZE];
+    cJSON** stack = local;
+    cJSON** newstack;
+    size_t depth = 0,capacity = PARSE_STACK_SIZE;
+    cJSON *parent,*child;
+    // 原地解析或者使用字符串池时，对象成员的键不需要释放
+    int constkeys = (ctx->insitu || ctx->pool) ? cJSON_StringIsConst : 0;
+    // 当前结点键的标记，数组元素为0
+    int keyflag = 0;
     if (!value)
     {
         return 0;
     }
-    //同一层结点之间，通过,号隔开,每次处理完一部分字符串剩余的字符串以,号开始
-    while (*value ==',')
+    for (;;)
     {
-        cJSON *new_item;
-        //内存申请失败
-        if (!(new_item = cJSON_New_Item()))
-        {
-           return 0;
-        }
-         child->next = new_item;
-        new_item->prev = child;
-        child = new_item;
-        //将同一级结点之间使用next和prev指针串起来，并且指向下一个结构继续处理
-        value = skip(parse_string(child,skip(value + 1)));
-        if (!value)
+        // 开始解析一个值
+        if (*value == '[' || *value == '{')
         {
-            return 0;
+            const char* start = value;
+            int type = (*value == '[') ? cJSON_Array : cJSON_Object;
+            item->type = type | keyflag;
+            value = skip(value + 1);
+            // 空数组或者空对象
+            if (*value == (type == cJSON_Array ? ']' : '}'))
+            {
+                value++;
+            }else{
+                if (depth >= nesting_limit)
+                {
+                    ep = start;
+                    goto fail;
+                }
+                // 栈满了就扩大一倍，普通深度的文档只用函数内的数组，不申请内存
+                if (depth == capacity)
+                {
+                    newstack = (cJSON**)mem_alloc(capacity * 2 * sizeof(cJSON*),MEM_OTHER);
+                    if (!newstack)
+                    {
+                        goto fail;
+                    }
+                    memcpy(newstack,stack,depth * sizeof(cJSON*));
+                    if (stack != local)
+                    {
+                        mem_free(stack,capacity * sizeof(cJSON*),MEM_OTHER);
+                    }
+                    stack = newstack;
+                    capacity *= 2;
+                }
+                stack[depth++] = item;
+                // 容器和第一个结点之间通过child进行连接
+                item->child = child = cJSON_New_Item();
+                if (!child)
+                {
+                    goto fail;
+                }
+                item = child;
+                keyflag = 0;
+                if (type == cJSON_Object)
+                {
+                    keyflag = constkeys;
+                    value = parse_member_key(item,value,ctx,keyflag);
+                    if (!value)
+                    {
+                        goto fail;
+                    }
+                }
+                // 接着解析第一个子结点的值
+                continue;
+            }
+        }else{
+            value = parse_scalar(item,value,ctx);
+            // parse_scalar会重写type，键的标记要重新加上
+            item->type |= keyflag;
+            if (!value)
+            {
+                goto fail;
+            }
         }
-        //给键赋值
-        child->string = child->valuestring;
-        child->valuestring = 0;
-        // 先将第一个子节点的"值"内容，赋给结点中的键，后面会从重新赋值
-        if (*value != ':')
+        // 一个值解析完成，回到它所在的容器，处理后面的逗号或者结束符
+        for (;;)
         {
+            if (!depth)
+            {
+                if (stack != local)
+                {
+                    mem_free(stack,capacity * sizeof(cJSON*),MEM_OTHER);
+                }
+                return value;
+            }
+            parent = stack[depth - 1];
+            value = skip(value);
+            // 同一层结点之间，通过,号隔开
+            if (*value == ',')
+            {
+                cJSON* new_item = cJSON_New_Item();
+                if (!new_item)
+                {
+                    goto fail;
+                }
+                //将同一级结点之间使用next和prev指针串起来，并且指向下一个结构继续处理
+                suffix_object(item,new_item);
+                item = new_item;
+                if ((parent->type & 255) == cJSON_Object)
+                {
+                    keyflag = constkeys;
+                    value = parse_member_key(item,skip(value + 1),ctx,keyflag);
+                    if (!value)
+                    {
+                        goto fail;
+                    }
+                }else{
+                    keyflag = 0;
+                    value = skip(value + 1);
+                }
+                break;
+            }
+            // 遇到容器的结尾标志，回到上一层
+            if (*value == (((parent->type & 255) == cJSON_Array) ? ']' : '}'))
+            {
+                value++;
+                item = parent;
+                depth--;
+                continue;
+            }
+            // 如果不是正确的结尾标志，则说明出错，ep指向错误字符，并且解析结束
             ep = value;
-            return 0;
+            goto fail;
         }
-        //递归的处理子节点，给值赋值
-        value = skip(parse_value(child,skip(value + 1)));
-        if (!value)
-        {
-            return 0;
-        }   
     }
-    if (*value == '}')
+fail:
+    if (stack != local)
     {
-        return value + 1;
+        mem_free(stack,capacity * sizeof(cJSON*),MEM_OTHER);
     }
-    ep = value;
     return 0;
 }
 
+// 解析整段文本到已经创建好的根节点c中，成功返回解析结束的位置，失败返回0并由ep指向出错位置
+static const char* parse_root(cJSON* c,const char* value,int require_null_terminated,parse_context* ctx){
+    const char* end;
+    ctx->strict = strict_strings;
+    if (ctx->strict && value)
+    {
+        ctx->end = value + strlen(value);
+    }
+    end = parse_value(c,skip(value),ctx);
+    if (!end)
+    {
+        return 0;
+    }
+    // 假设设置了这个标志位，要求最终的结束字符是null
+    if (require_null_terminated)
+    {
+        // 跳过开头的字符
+        end = skip(end);
+        //如果依旧存在字符，说明要解析的文本不符合规定，若输入为\"nullyuanlixiang\"，通过parse_value后，end = "yuanlixiang",不符合以"null"结尾的要求，同时是ep指向出错的字符串
+        if (*end)
+        {
+            ep = end;
+            return 0;
+        }
+    }
+    return end;
+}
+
 // value为需要解析的文本，require_null_terminated为一个标识符，
 // return_parse_end为一个二级指针，用于获取出现错误部分的字符串，由于需要在函数内部改变其指向，故设置为二级指针（一级指针没效果，推出函数即消失）
 cJSON* cJSON_ParseWithOpts(const char* value,const char** return_parse_end,int require_null_terminated){
     const char* end = 0;
+    parse_context ctx = {0};
+    ctx.pool = intern_pool;
     // 创建一个结构体，用于存储字符串中的内容
     cJSON *c = cJSON_New_Item();
     // 全局变量，ep指向了出错的字符串，当需要获得出错的字符串的时候，可通过调用函数cJSON_GetErrorPtr()查看
@@ -1447,26 +2697,13 @@ cJSON* cJSON_ParseWithOpts(const char* value,const char** return_parse_end,int r
     {
         return 0;
     }
-    end = parse_value(c,skip(value));
-    //出错的话释放内存，ep = 0
+    end = parse_root(c,value,require_null_terminated,&ctx);
+    //出错的话释放内存
     if (!end)
     {
         cJSON_Delete(c);
         return 0;
     }
-    // 假设设置了这个标志位，要求最终的结束字符是null
-    if (require_null_terminated)
-    {
-        // 跳过开头的字符
-        end = skip(end);
-        //如果依旧存在字符，说明要解析的文本不符合规定，若输入为\"nullyuanlixiang\"，通过parse_value后，end = "yuanlixiang",不符合以"null"结尾的要求，故释放内存，同时是ep指向出错的字符串
-        if (*end)
-        {
-            cJSON_Delete(c);
-            ep = end;
-            return 0;
-        }
-    }
     // 二维指针，获得解析完毕的情况下end中的内容
     if (return_parse_end)
     {
@@ -1481,17 +2718,64 @@ cJSON* cJSON_Parse(const char* value){
     return cJSON_ParseWithOpts(value,0,0);
 }
 
-cJSON* cJSON_DetachItemFromArray(cJSON *array,int which){
-    cJSON *c = array->child;
-    while (c && which > 0)
+// 原地解析，value必须可写且在整个树的生命周期内有效，树中的字符串全部指向value
+cJSON* cJSON_ParseInSitu(char* value){
+    parse_context ctx;
+    cJSON *c = cJSON_New_Item();
+    memset(&ctx,0,sizeof(parse_context));
+    ctx.insitu = 1;
+    ep = 0;
+    if (!c)
     {
-        c = c->next;
-        which--;
+        return 0;
     }
-    if (!c)
+    if (!parse_root(c,value,0,&ctx))
+    {
+        cJSON_Delete(c);
+        return 0;
+    }
+    return c;
+}
+
+// 通过内存映射解析文件，映射区域本身就是原地解析的缓冲区
+cJSON* cJSON_ParseFile(const char* path){
+    cJSON_Mapped *doc;
+    char *map;
+    size_t len = 0,maplen = 0;
+    parse_context ctx;
+    memset(&ctx,0,sizeof(parse_context));
+    ctx.insitu = 1;
+    ep = 0;
+    map = map_file(path,&len,&maplen);
+    if (!map)
+    {
+        return 0;
+    }
+    doc = (cJSON_Mapped*)mem_alloc(sizeof(cJSON_Mapped),MEM_NODE);
+    if (!doc)
+    {
+        unmap_file(map,maplen);
+        return 0;
+    }
+    memset(doc,0,sizeof(cJSON_Mapped));
+    doc->map = map;
+    doc->maplen = maplen;
+    // 文件末尾之后至少还有一个为0的字节（见map_file），所以可以直接当作以'\0'结尾的文本解析
+    if (!parse_root(&doc->item,map,1,&ctx))
     {
+        // ep指向映射区域，映射释放后不能再使用
+        ep = 0;
+        doc->item.type |= cJSON_OwnsMapping;
+        cJSON_Delete(&doc->item);
         return 0;
     }
+    // parse_value会重写type，所以在解析完成后再打上标记
+    doc->item.type |= cJSON_OwnsMapping;
+    return &doc->item;
+}
+
+// 把子结点c从parent的链表中取下来
+static void node_unlink(cJSON* parent,cJSON* c){
     if (c->prev)
     {
         c->prev->next = c->next;
@@ -1500,36 +2784,53 @@ cJSON* cJSON_DetachItemFromArray(cJSON *array,int which){
     {
         c->next->prev = c->prev;
     }
-    if (c == array->child)
+    if (c == parent->child)
     {
-        array->child = c->next;
+        parent->child = c->next;
     }
     c->prev = c->next = 0;
-    return c;
-}
-
-void cJSON_DeleteItemFromArray(cJSON* array,int which){
-    cJSON_Delete(cJSON_DetachItemFromArray(array,which));
 }
 
-static int cJSON_strcasecmp(const char* s1,const char* s2){
-    if (!s1)
+cJSON* cJSON_DetachItemFromArray(cJSON *array,int which){
+    cJSON *c;
+    if (!cJSON_Unshare(array))
     {
-        return (s1 == s2) ? 0 : 1;
-        if (s2)
-        {
-            return 1;
-        }
-        for(;tolower(*s1) == tolower(*s2);++s1,++s2){
-            if (*s1 == 0)
-            {
-                return 0;
-            }
-            
+        return 0;
+    }
+    c = array->child;
+    while (c && which > 0)
+    {
+        c = c->next;
+        which--;
+    }
+    if (!c)
+    {
+        return 0;
+    }
+    node_unlink(array,c);
+    return c;
+}
+
+void cJSON_DeleteItemFromArray(cJSON* array,int which){
+    cJSON_Delete(cJSON_DetachItemFromArray(array,which));
+}
+
+static int cJSON_strcasecmp(const char* s1,const char* s2){
+    if (!s1)
+    {
+        return (s1 == s2) ? 0 : 1;
+    }
+    if (!s2)
+    {
+        return 1;
+    }
+    for(;tolower(*(const unsigned char *)s1) == tolower(*(const unsigned char *)s2);++s1,++s2){
+        if (*s1 == 0)
+        {
+            return 0;
         }
-        return tolower(*(const unsigned char *)s1) - tolower(*(const unsigned char *)s2);
     }
-    
+    return tolower(*(const unsigned char *)s1) - tolower(*(const unsigned char *)s2);
 }
 
 cJSON* cJSON_DetachItemFromObject(cJSON *object,const char *string){
@@ -1551,6 +2852,24 @@ void cJSON_DeleteItemFromObject(cJSON *object,const char* string){
     cJSON_Delete(cJSON_DetachItemFromObject(object,string));
 }
 
+// 取字符串结点的值，不是字符串结点时返回0
+const char* cJSON_GetStringValue(const cJSON* item){
+    if (!item || (item->type & 255) != cJSON_String)
+    {
+        return 0;
+    }
+    return item->valuestring;
+}
+
+// 取数值结点的值，不是数值结点时返回0
+double cJSON_GetNumberValue(const cJSON* item){
+    if (!item || (item->type & 255) != cJSON_Number)
+    {
+        return 0;
+    }
+    return item->valuedouble;
+}
+
 // 返回节点的个数,注意是某个特顶层的，其子层和父层的结点不会被计算
 int cJSON_GetArraySize(cJSON *array){
     cJSON *c = array->child;
@@ -1585,7 +2904,12 @@ cJSON *cJSON_GetObjectItem(cJSON* object,const char* string){
 
 //在链表中的指定位置插入一个新结点，array或object的child指向的元素为第一个结构，which从0开始
 void cJSON_InsertItemInArray(cJSON* array,int which,cJSON* newitem){
-    cJSON *c = array->child;
+    cJSON *c;
+    if (!cJSON_Unshare(array))
+    {
+        return;
+    }
+    c = array->child;
     // 找到which位置
     // 找到要添加的位置
     while (c && which > 0)
@@ -1617,7 +2941,12 @@ void cJSON_InsertItemInArray(cJSON* array,int which,cJSON* newitem){
 
 // array中的替换节点操作，用新的节点替换原有的某一个节点
 void cJSON_ReplaceItemInArray(cJSON* array,int which,cJSON* newitem){
-    cJSON* c = array->child;
+    cJSON* c;
+    if (!cJSON_Unshare(array))
+    {
+        return;
+    }
+    c = array->child;
     // 找到which位置
     while (c && which > 0)
     {
@@ -1663,48 +2992,62 @@ void cJSON_ReplaceItemInObject(cJSON* object,const char* string,cJSON* newitem){
     // 调用array中的结点替换方式进行替换
     if (c)
     {
-        newitem->string = cJSON_strdup(string);
+        node_set_key(newitem,string);
         cJSON_ReplaceItemInArray(object,i,newitem);
     }
 }
 
-// 拷贝副本操作，后面的recurse用于判断是否进行递归copy多个结点，如果启用了recurse会把后面的整条链拷贝一份，当然这个时候传入的item必须是一个object或array
-cJSON *cJSON_Duplicate(cJSON *item,int recurse){
-    cJSON *newitem,*cptr,*nptr = 0,*newchild;
-    if (!item)
-    {
-        return 0;
-    }
-    //创建一个新结点
-    newitem = cJSON_New_Item();
+// 复制单个结点（键、类型和值），不处理子结点
+static cJSON *node_copy(cJSON *item){
+    cJSON *newitem = cJSON_New_Item();
     if (!newitem)
     {
         return 0;
     }
     // 将指定结点的内容赋给刚申请的结点
-    newitem->type = item->type & (~cJSON_IsReference);
+    // 新结点的键和值都会重新复制一份，映射区域也只归原来的根节点所有
+    newitem->type = item->type & (~(cJSON_IsReference | cJSON_StringIsConst | cJSON_OwnsMapping));
     newitem->valuedoint = item->valuedoint;
-    newitem->valuedouble = item->valuedouble;
-    if (item->valuestring)
+    if (node_valuestring(item))
     {
         //动态内存分配存储字符串的内容
-        newitem->valuestring = cJSON_strdup(item->valuestring);
+        newitem->valuestring = node_strdup(newitem,0,item->valuestring);
         if (!newitem->valuestring)
         {
             //出错释放内存
             cJSON_Delete(newitem);
             return 0;
         }
+    }else{
+        // 紧凑布局下valuedouble和valuestring共用内存，只有非字符串结点才复制数值
+        newitem->valuedouble = item->valuedouble;
     }
     if (item->string)
     {
-        newitem->string = cJSON_strdup(item->string);
-        if (!newitem->string)
+        if (!node_set_key(newitem,item->string))
         {
-            cJSON_free(newitem);
+            cJSON_Delete(newitem);
             return 0;
         }
     }
+    return newitem;
+}
+
+// 拷贝副本操作，后面的recurse用于判断是否进行递归copy多个结点，如果启用了recurse会把后面的整条链拷贝一份，当然这个时候传入的item必须是一个object或array
+cJSON *cJSON_Duplicate(cJSON *item,int recurse){
+    cJSON *newitem,*cptr,*nptr = 0,*newchild;
+    if (!item)
+    {
+        return 0;
+    }
+    //创建一个新结点
+    newitem = node_copy(item);
+    if (!newitem)
+    {
+        return 0;
+    }
+    // 不递归时副本没有子结点，缓存的哈希不再成立；深拷贝常常用普通的取值接口修改，也不带上缓存
+    newitem->type &= ~cJSON_HashValid;
     //加入不需要递归拷贝的话，直接返回刚创建的结点
     if (!recurse)
     {
@@ -1737,3 +3080,5514 @@ cJSON *cJSON_Duplicate(cJSON *item,int recurse){
     }
     return newitem;
 }
+
+// 写时复制的副本：只复制item本身，子结点链表和原来的结点共享，增加链表头的共享计数
+cJSON *cJSON_DuplicateShared(cJSON *item){
+    cJSON *newitem;
+    if (!item)
+    {
+        return 0;
+    }
+    newitem = node_copy(item);
+    if (!newitem)
+    {
+        return 0;
+    }
+    // 引用结点不拥有子结点，副本也不能共享
+    if (item->child && !(item->type & cJSON_IsReference))
+    {
+        newitem->child = item->child;
+        share_acquire(item->child);
+    }
+    return newitem;
+}
+
+// 容器的子结点链表正在被其它容器共享时，先给它复制一份自己的链表，之后就可以放心修改
+// 复制是浅的：子结点中的容器继续共享它们下一层的链表，所以代价只和这一层的结点个数有关
+static int cJSON_Unshare(cJSON *item){
+    cJSON *c,*copy,*head = 0,*tail = 0;
+    // 所有修改容器的接口都从这里经过，缓存的哈希随之失效
+    item->type &= ~cJSON_HashValid;
+    if (!item->child || !share_load(&item->child->refcount))
+    {
+        return 1;
+    }
+    for (c = item->child;c;c = c->next)
+    {
+        copy = node_copy(c);
+        if (!copy)
+        {
+            // 已经复制出来的结点和它们共享的链表计数由cJSON_Delete处理
+            cJSON_Delete(head);
+            return 0;
+        }
+        if (c->child && !(c->type & cJSON_IsReference))
+        {
+            copy->child = c->child;
+            share_acquire(c->child);
+        }
+        if (tail)
+        {
+            suffix_object(tail,copy);
+        }else{
+            head = copy;
+        }
+        tail = copy;
+    }
+    // 复制期间其它拥有者可能已经都释放了，这时旧的链表只剩自己，要释放掉
+    if (share_release(item->child))
+    {
+        cJSON_Delete(item->child);
+    }
+    item->child = head;
+    return 1;
+}
+
+// 取数组中的结点准备修改，写时复制的树会先复制这一层的链表
+cJSON *cJSON_GetArrayItemMutable(cJSON *array,int item){
+    if (!cJSON_Unshare(array))
+    {
+        return 0;
+    }
+    return cJSON_GetArrayItem(array,item);
+}
+
+cJSON *cJSON_GetObjectItemMutable(cJSON *object,const char *string){
+    if (!cJSON_Unshare(object))
+    {
+        return 0;
+    }
+    return cJSON_GetObjectItem(object,string);
+}
+
+/* 结构比较和哈希 */
+
+// 容器的哈希缓存在valuedouble中（数组和对象不使用它），type中的cJSON_HashValid表示缓存有效
+#define node_cacheable(item) (((item)->type & 255) >= cJSON_Array && !((item)->type & cJSON_IsReference))
+
+static unsigned long long hash_mix(unsigned long long h){
+    // splitmix64的最后一步，让每一位都影响结果
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+// FNV-1a
+static unsigned long long hash_string(const char* s){
+    unsigned long long h = 0xCBF29CE484222325ULL;
+    if (s)
+    {
+        while (*s)
+        {
+            h = (h ^ (unsigned char)*s++) * 0x100000001B3ULL;
+        }
+    }
+    return h;
+}
+
+static int node_cached_hash(const cJSON* item,unsigned long long* h){
+    if (!(item->type & cJSON_HashValid))
+    {
+        return 0;
+    }
+    memcpy(h,&item->valuedouble,sizeof(*h));
+    return 1;
+}
+
+// 计算到一半的容器：数组按顺序累积，对象把每个成员的哈希相加，与成员顺序无关
+typedef struct
+{
+    const cJSON* node;
+    const cJSON* next;
+    unsigned long long h;
+    size_t count;
+} hash_frame;
+
+static void hash_start(hash_frame* f,const cJSON* item){
+    f->node = item;
+    f->next = item->child;
+    f->h = 0;
+    f->count = 0;
+}
+
+static void hash_add(hash_frame* f,const cJSON* child,unsigned long long h){
+    if ((f->node->type & 255) == cJSON_Object)
+    {
+        f->h += hash_mix(hash_string(child->string) ^ (h * 0x9E3779B97F4A7C15ULL));
+    }else{
+        f->h = (f->h ^ h) * 0x100000001B3ULL + 0x9E3779B97F4A7C15ULL;
+    }
+    f->count++;
+}
+
+// 差异计算临时缓存的哈希：记下写过缓存的结点，返回前清除，调用者的树上不留下缓存
+typedef struct
+{
+    cJSON** nodes;
+    size_t count;
+    size_t capacity;
+} hash_marks;
+
+static int hash_mark(hash_marks* marks,cJSON* node){
+    cJSON** nodes;
+    if (marks->count == marks->capacity)
+    {
+        nodes = (cJSON**)mem_alloc((marks->capacity ? marks->capacity * 2 : 64) * sizeof(cJSON*),MEM_OTHER);
+        if (!nodes)
+        {
+            return 0;
+        }
+        if (marks->nodes)
+        {
+            memcpy(nodes,marks->nodes,marks->count * sizeof(cJSON*));
+            mem_free(marks->nodes,marks->capacity * sizeof(cJSON*),MEM_OTHER);
+        }
+        marks->nodes = nodes;
+        marks->capacity = marks->capacity ? marks->capacity * 2 : 64;
+    }
+    marks->nodes[marks->count++] = node;
+    return 1;
+}
+
+static void hash_unmark(hash_marks* marks){
+    size_t i;
+    for (i = 0;i < marks->count;i++)
+    {
+        marks->nodes[i]->type &= ~cJSON_HashValid;
+    }
+    if (marks->nodes)
+    {
+        mem_free(marks->nodes,marks->capacity * sizeof(cJSON*),MEM_OTHER);
+    }
+}
+
+// marks不为0时缓存只是临时的，记不下来的结点不缓存
+static unsigned long long hash_finish(hash_frame* f,int cache,hash_marks* marks){
+    unsigned long long h = hash_mix(f->h ^ ((unsigned long long)(f->node->type & 255) << 56) ^ f->count);
+    if (cache && node_cacheable(f->node) && (!marks || hash_mark(marks,(cJSON*)f->node)))
+    {
+        cJSON* node = (cJSON*)f->node;
+        memcpy(&node->valuedouble,&h,sizeof(h));
+        node->type |= cJSON_HashValid;
+    }
+    return h;
+}
+
+// 标量的哈希；容器有缓存时返回缓存，没有时返回0，由调用者展开
+static int hash_leaf(const cJSON* item,unsigned long long* h){
+    double d;
+    switch (item->type & 255)
+    {
+    case cJSON_Number:
+        // -0和0相等，哈希也要相同
+        d = item->valuedouble == 0 ? 0 : item->valuedouble;
+        memcpy(h,&d,sizeof(*h));
+        *h = hash_mix(*h ^ ((unsigned long long)cJSON_Number << 56));
+        return 1;
+    case cJSON_String:
+        *h = hash_mix(hash_string(item->valuestring) ^ ((unsigned long long)cJSON_String << 56));
+        return 1;
+    case cJSON_Array:
+    case cJSON_Object:
+        return node_cached_hash(item,h);
+    default:
+        *h = hash_mix((unsigned long long)(item->type & 255) << 56);
+        return 1;
+    }
+}
+
+// 不递归：每个展开中的容器占一个栈帧，子结点算完后累积到父结点的栈帧中
+static unsigned long long hash_tree(const cJSON* item,int cache,hash_marks* marks){
+    hash_frame local[32];
+    hash_frame* stack = local;
+    hash_frame* newstack;
+    size_t capacity = sizeof(local) / sizeof(local[0]);
+    size_t depth = 1;
+    unsigned long long h = 0;
+    const cJSON* c;
+    if (!item)
+    {
+        return 0;
+    }
+    if (hash_leaf(item,&h))
+    {
+        return h;
+    }
+    hash_start(stack,item);
+    while (depth)
+    {
+        c = stack[depth - 1].next;
+        if (c)
+        {
+            stack[depth - 1].next = c->next;
+            if (hash_leaf(c,&h))
+            {
+                hash_add(stack + depth - 1,c,h);
+                continue;
+            }
+            if (depth == capacity)
+            {
+                newstack = (hash_frame*)mem_alloc(capacity * 2 * sizeof(hash_frame),MEM_OTHER);
+                if (!newstack)
+                {
+                    h = 0;
+                    break;
+                }
+                memcpy(newstack,stack,depth * sizeof(hash_frame));
+                if (stack != local)
+                {
+                    mem_free(stack,capacity * sizeof(hash_frame),MEM_OTHER);
+                }
+                stack = newstack;
+                capacity *= 2;
+            }
+            hash_start(stack + depth++,c);
+            continue;
+        }
+        h = hash_finish(stack + --depth,cache,marks);
+        if (depth)
+        {
+            hash_add(stack + depth - 1,stack[depth].node,h);
+        }
+    }
+    if (stack != local)
+    {
+        mem_free(stack,capacity * sizeof(hash_frame),MEM_OTHER);
+    }
+    return h;
+}
+
+unsigned long long cJSON_Hash(const cJSON* item){
+    return hash_tree(item,0,0);
+}
+
+unsigned long long cJSON_CacheHash(cJSON* item){
+    return hash_tree(item,1,0);
+}
+
+// 待比较的结点对
+typedef struct
+{
+    const cJSON* a;
+    const cJSON* b;
+} compare_pair;
+
+typedef struct
+{
+    compare_pair local[32];
+    compare_pair* pairs;
+    size_t count;
+    size_t capacity;
+} compare_stack;
+
+static int compare_push(compare_stack* s,const cJSON* a,const cJSON* b){
+    compare_pair* newpairs;
+    if (s->count == s->capacity)
+    {
+        newpairs = (compare_pair*)mem_alloc(s->capacity * 2 * sizeof(compare_pair),MEM_OTHER);
+        if (!newpairs)
+        {
+            return 0;
+        }
+        memcpy(newpairs,s->pairs,s->count * sizeof(compare_pair));
+        if (s->pairs != s->local)
+        {
+            mem_free(s->pairs,s->capacity * sizeof(compare_pair),MEM_OTHER);
+        }
+        s->pairs = newpairs;
+        s->capacity *= 2;
+    }
+    s->pairs[s->count].a = a;
+    s->pairs[s->count].b = b;
+    s->count++;
+    return 1;
+}
+
+static size_t count_members(const cJSON* c){
+    size_t n = 0;
+    for (;c;c = c->next)
+    {
+        n++;
+    }
+    return n;
+}
+
+#define member_key(item) ((item)->string ? (item)->string : "")
+
+// 表中已经删除的成员留下的标记，查找时跳过
+static const cJSON member_removed;
+
+// 在有size个槽的开放寻址表中找键为key的成员，没有时返回空槽的位置
+static size_t member_slot(const cJSON** table,size_t size,const char* key){
+    size_t i;
+    for (i = hash_string(key) & (size - 1);table[i];i = (i + 1) & (size - 1))
+    {
+        if (table[i] != &member_removed && !strcmp(key,member_key(table[i])))
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+// 按键名（区分大小写）查找对象的成员，用于依次查找另一个对象的全部成员
+// 先看上一个找到的成员的下一个，顺序一致时每次只比较一次；不一致时循环往后找，
+// 成员多且不一致了好几次之后才给键建一张开放寻址的表（只查几个键时不值得），建不起来就继续循环查找
+typedef struct
+{
+    const cJSON* object;
+    const cJSON* hint;
+    const cJSON** table;
+    size_t size;
+    // 表中占用的槽，包括删除标记
+    size_t filled;
+    size_t misses;
+} member_index;
+
+static void member_index_init(member_index* ix,const cJSON* object){
+    ix->object = object;
+    ix->hint = object->child;
+    ix->table = 0;
+    ix->size = 0;
+    ix->filled = 0;
+    ix->misses = 0;
+}
+
+static void member_index_free(member_index* ix){
+    if (ix->table)
+    {
+        mem_free(ix->table,ix->size * sizeof(cJSON*),MEM_OTHER);
+    }
+}
+
+static const cJSON* member_find(member_index* ix,const char* key){
+    const cJSON* m = ix->hint;
+    size_t count;
+    if (!m)
+    {
+        return 0;
+    }
+    if (strcmp(key,member_key(m)))
+    {
+        // 成员个数只在考虑建表时才数，成员少时过一阵子再数
+        if (!ix->table && ++ix->misses > 4)
+        {
+            count = count_members(ix->object->child);
+            ix->misses = count > 16 ? ix->misses : 0;
+            for (ix->size = 2;count > 16 && ix->size < count * 2;ix->size *= 2)
+            {
+            }
+            ix->table = count > 16 ? (const cJSON**)mem_alloc(ix->size * sizeof(cJSON*),MEM_OTHER) : 0;
+            if (ix->table)
+            {
+                memset(ix->table,0,ix->size * sizeof(cJSON*));
+                for (m = ix->object->child;m;m = m->next)
+                {
+                    ix->table[member_slot(ix->table,ix->size,member_key(m))] = m;
+                }
+                ix->filled = count;
+            }
+            m = ix->hint;
+        }
+        if (ix->table)
+        {
+            m = ix->table[member_slot(ix->table,ix->size,key)];
+            if (!m)
+            {
+                return 0;
+            }
+        }else{
+            do
+            {
+                m = m->next ? m->next : ix->object->child;
+            } while (m != ix->hint && strcmp(key,member_key(m)));
+            if (m == ix->hint)
+            {
+                return 0;
+            }
+        }
+    }
+    ix->hint = m->next ? m->next : ix->object->child;
+    return m;
+}
+
+// 只看两个结点本身：相等返回1，不等返回0，需要比较子结点的容器返回-1
+// 共享同一条子结点链表（写时复制的副本）时不用再往下比较，两边都缓存了哈希且不同时直接判定不相等
+static int compare_node(const cJSON* x,const cJSON* y){
+    unsigned long long hx,hy;
+    if (x == y)
+    {
+        return 1;
+    }
+    if (!x || !y || (x->type & 255) != (y->type & 255))
+    {
+        return 0;
+    }
+    switch (x->type & 255)
+    {
+    case cJSON_Number:
+        return x->valuedouble == y->valuedouble;
+    case cJSON_String:
+        return !strcmp(x->valuestring ? x->valuestring : "",y->valuestring ? y->valuestring : "");
+    case cJSON_Array:
+    case cJSON_Object:
+        if (x->child == y->child)
+        {
+            return 1;
+        }
+        if (node_cached_hash(x,&hx) && node_cached_hash(y,&hy) && hx != hy)
+        {
+            return 0;
+        }
+        return -1;
+    default:
+        return 1;
+    }
+}
+
+// 对象的成员m将要被取下，在node_unlink之前调用
+static void member_index_remove(member_index* ix,const cJSON* m){
+    size_t i;
+    if (ix->hint == m)
+    {
+        ix->hint = m->next ? m->next : ix->object->child;
+        ix->hint = ix->hint == m ? 0 : ix->hint;
+    }
+    if (ix->table)
+    {
+        for (i = hash_string(member_key(m)) & (ix->size - 1);ix->table[i];i = (i + 1) & (ix->size - 1))
+        {
+            if (ix->table[i] == m)
+            {
+                ix->table[i] = &member_removed;
+                break;
+            }
+        }
+    }
+}
+
+// 成员m已经接到对象中；表太满时丢掉，下次查找不到时再重建
+static void member_index_add(member_index* ix,const cJSON* m){
+    if (!ix->hint)
+    {
+        ix->hint = m;
+    }
+    if (ix->table && (ix->filled + 1) * 2 > ix->size)
+    {
+        member_index_free(ix);
+        ix->table = 0;
+    }else if (ix->table)
+    {
+        ix->table[member_slot(ix->table,ix->size,member_key(m))] = m;
+        ix->filled++;
+    }
+}
+
+// compare_members中按键配对用的表：键相同的成员按出现的顺序串起来，head是其中第一个还没有配对的成员
+typedef struct
+{
+    const char* key;
+    size_t head;
+} compare_slot;
+
+#define COMPARE_LOCAL 16
+
+// 配对一对子结点：标量直接比较，容器放到栈中
+static int compare_pair_push(compare_stack* s,const cJSON* x,const cJSON* y){
+    int ok = compare_node(x,y);
+    return ok < 0 ? compare_push(s,x,y) : ok;
+}
+
+// 不考虑顺序地配对两个成员个数相同的对象的成员，b的每个成员只配对一次，重复的键按出现的顺序配对。
+// 先按位置配对键相同的开头部分（顺序一致时就是全部）；剩下的成员给b建一张键的表，配对一个就取同一个键的下一个
+static int compare_members(compare_stack* s,const cJSON* a,const cJSON* b){
+    compare_slot localslots[COMPARE_LOCAL * 2];
+    const cJSON* localmembers[COMPARE_LOCAL];
+    size_t localsame[COMPARE_LOCAL];
+    compare_slot* slots = localslots;
+    const cJSON** members = localmembers;
+    size_t* same;
+    const cJSON* c = a->child;
+    const cJSON* m = b->child;
+    size_t n = 0;
+    size_t size;
+    size_t i;
+    size_t j;
+    int ok = 1;
+    for (;c && m && !strcmp(member_key(c),member_key(m));c = c->next,m = m->next)
+    {
+        if (!compare_pair_push(s,c,m))
+        {
+            return 0;
+        }
+    }
+    if (!c)
+    {
+        return 1;
+    }
+    n = count_members(m);
+    for (size = 2;size < n * 2;size *= 2)
+    {
+    }
+    same = localsame;
+    if (n > COMPARE_LOCAL)
+    {
+        slots = (compare_slot*)mem_alloc(size * sizeof(compare_slot) + n * (sizeof(cJSON*) + sizeof(size_t)),MEM_OTHER);
+        if (!slots)
+        {
+            return 0;
+        }
+        members = (const cJSON**)(slots + size);
+        same = (size_t*)(members + n);
+    }
+    for (i = 0;i < size;i++)
+    {
+        slots[i].key = 0;
+    }
+    for (i = 0;i < n;i++,m = m->next)
+    {
+        members[i] = m;
+    }
+    // 从后往前插入，同一个键的成员串成按出现顺序的链
+    for (i = n;i-- > 0;)
+    {
+        for (j = hash_string(member_key(members[i])) & (size - 1);slots[j].key && strcmp(slots[j].key,member_key(members[i]));j = (j + 1) & (size - 1))
+        {
+        }
+        same[i] = slots[j].key ? slots[j].head : n;
+        slots[j].key = member_key(members[i]);
+        slots[j].head = i;
+    }
+    for (;c && ok;c = c->next)
+    {
+        for (j = hash_string(member_key(c)) & (size - 1);slots[j].key && strcmp(slots[j].key,member_key(c));j = (j + 1) & (size - 1))
+        {
+        }
+        if (!slots[j].key || slots[j].head == n)
+        {
+            ok = 0;
+            break;
+        }
+        i = slots[j].head;
+        slots[j].head = same[i];
+        ok = compare_pair_push(s,c,members[i]);
+    }
+    if (slots != localslots)
+    {
+        mem_free(slots,size * sizeof(compare_slot) + n * (sizeof(cJSON*) + sizeof(size_t)),MEM_OTHER);
+    }
+    return ok;
+}
+
+// 不递归：还要比较子结点的容器对放在栈中，标量直接比较
+int cJSON_Compare(const cJSON* a,const cJSON* b,int unordered){
+    compare_stack s;
+    const cJSON* x;
+    const cJSON* y;
+    size_t n;
+    int equal;
+    equal = compare_node(a,b);
+    if (equal >= 0)
+    {
+        return equal;
+    }
+    equal = 1;
+    s.pairs = s.local;
+    s.count = 0;
+    s.capacity = sizeof(s.local) / sizeof(s.local[0]);
+    compare_push(&s,a,b);
+    while (s.count && equal)
+    {
+        s.count--;
+        x = s.pairs[s.count].a;
+        y = s.pairs[s.count].b;
+        if ((x->type & 255) == cJSON_Object && unordered)
+        {
+            n = count_members(x->child);
+            equal = n == count_members(y->child) && (!n || compare_members(&s,x,y));
+            continue;
+        }
+        for (x = x->child,y = y->child;x && y && equal;x = x->next,y = y->next)
+        {
+            if (x->string || y->string)
+            {
+                equal = !strcmp(x->string ? x->string : "",y->string ? y->string : "");
+            }
+            if (equal)
+            {
+                equal = compare_node(x,y);
+                equal = equal < 0 ? compare_push(&s,x,y) : equal;
+            }
+        }
+        equal = equal && !x && !y;
+    }
+    if (s.pairs != s.local)
+    {
+        mem_free(s.pairs,s.capacity * sizeof(compare_pair),MEM_OTHER);
+    }
+    return equal;
+}
+
+/* JSON Patch（RFC 6902） */
+
+// 生成补丁时的状态：补丁数组和它的最后一个元素，以及当前位置的JSON Pointer
+typedef struct
+{
+    cJSON* patch;
+    cJSON* tail;
+    char* path;
+    size_t len;
+    size_t size;
+    int failed;
+} patch_context;
+
+// 在路径后面接上一段，'~'和'/'按RFC 6901转义成"~0"和"~1"，返回接之前的长度，用来恢复
+static size_t patch_push(patch_context* ctx,const char* segment){
+    size_t old = ctx->len;
+    size_t need = ctx->len + 2 + strlen(segment) * 2;
+    char* path;
+    if (need > ctx->size)
+    {
+        path = (char*)mem_realloc(ctx->path,ctx->size,need * 2,MEM_OTHER);
+        if (!path)
+        {
+            ctx->failed = 1;
+            return old;
+        }
+        ctx->path = path;
+        ctx->size = need * 2;
+    }
+    ctx->path[ctx->len++] = '/';
+    for (;*segment;segment++)
+    {
+        if (*segment == '~' || *segment == '/')
+        {
+            ctx->path[ctx->len++] = '~';
+            ctx->path[ctx->len++] = *segment == '~' ? '0' : '1';
+        }else{
+            ctx->path[ctx->len++] = *segment;
+        }
+    }
+    ctx->path[ctx->len] = 0;
+    return old;
+}
+
+static size_t patch_push_index(patch_context* ctx,size_t index){
+    char segment[24];
+    sprintf(segment,"%lu",(unsigned long)index);
+    return patch_push(ctx,segment);
+}
+
+static void patch_pop(patch_context* ctx,size_t old){
+    ctx->len = old;
+    if (ctx->path)
+    {
+        ctx->path[old] = 0;
+    }
+}
+
+// 在补丁的最后加一个操作；值是写时复制的副本，和目标树共享子结点
+static void patch_emit(patch_context* ctx,const char* op,cJSON* value){
+    cJSON* item;
+    cJSON* name;
+    cJSON* path;
+    cJSON* copy = 0;
+    if (ctx->failed)
+    {
+        return;
+    }
+    item = cJSON_CreateObject();
+    name = cJSON_CreateString(op);
+    path = cJSON_CreateString(ctx->path ? ctx->path : "");
+    if (value)
+    {
+        copy = cJSON_DuplicateShared(value);
+    }
+    if (copy)
+    {
+        // 副本复制了结点的type，差异计算期间临时缓存的哈希不能带进补丁
+        copy->type &= ~cJSON_HashValid;
+    }
+    if (!item || !name || !path || !name->valuestring || !path->valuestring || (value && !copy))
+    {
+        cJSON_Delete(item);
+        cJSON_Delete(name);
+        cJSON_Delete(path);
+        cJSON_Delete(copy);
+        ctx->failed = 1;
+        return;
+    }
+    cJSON_AddItemToObject(item,"op",name);
+    cJSON_AddItemToObject(item,"path",path);
+    if (copy)
+    {
+        cJSON_AddItemToObject(item,"value",copy);
+    }
+    // 补丁数组是新建的，直接接在尾部，不用每次从头找
+    if (ctx->tail)
+    {
+        suffix_object(ctx->tail,item);
+    }else{
+        ctx->patch->child = item;
+    }
+    ctx->tail = item;
+}
+
+static void patch_diff(patch_context* ctx,cJSON* from,cJSON* to);
+
+// 对象按键名配对：from中有to中没有的删除，都有的比较下去，to中多出来的添加
+static void patch_diff_object(patch_context* ctx,cJSON* from,cJSON* to){
+    member_index in_to;
+    member_index in_from;
+    cJSON* c;
+    cJSON* m;
+    size_t old;
+    member_index_init(&in_to,to);
+    member_index_init(&in_from,from);
+    for (c = from->child;c && !ctx->failed;c = c->next)
+    {
+        m = (cJSON*)member_find(&in_to,member_key(c));
+        // 先比较再接路径，相同的成员不用动路径
+        if (m && cJSON_Compare(c,m,1))
+        {
+            continue;
+        }
+        old = patch_push(ctx,member_key(c));
+        if (m)
+        {
+            patch_diff(ctx,c,m);
+        }else{
+            patch_emit(ctx,"remove",0);
+        }
+        patch_pop(ctx,old);
+    }
+    for (c = to->child;c && !ctx->failed;c = c->next)
+    {
+        if (!member_find(&in_from,member_key(c)))
+        {
+            old = patch_push(ctx,member_key(c));
+            patch_emit(ctx,"add",c);
+            patch_pop(ctx,old);
+        }
+    }
+    member_index_free(&in_to);
+    member_index_free(&in_from);
+}
+
+// 数组先去掉两边相同的开头和结尾，中间部分逐个位置比较下去，多出来的元素删除或添加
+// 这样在任意位置插入或删除一段连续的元素都只生成这几个元素的操作
+static void patch_diff_array(patch_context* ctx,cJSON* from,cJSON* to){
+    cJSON* a = from->child;
+    cJSON* b = to->child;
+    cJSON* alast = a;
+    cJSON* blast = b;
+    size_t na = 0,nb = 0;
+    size_t prefix = 0;
+    size_t suffix = 0;
+    size_t i;
+    size_t old;
+    while (a && b && cJSON_Compare(a,b,1))
+    {
+        a = a->next;
+        b = b->next;
+        prefix++;
+    }
+    for (;alast && alast->next;alast = alast->next)
+    {
+        na++;
+    }
+    na += alast ? 1 : 0;
+    for (;blast && blast->next;blast = blast->next)
+    {
+        nb++;
+    }
+    nb += blast ? 1 : 0;
+    while (prefix + suffix < na && prefix + suffix < nb && cJSON_Compare(alast,blast,1))
+    {
+        alast = alast->prev;
+        blast = blast->prev;
+        suffix++;
+    }
+    na -= prefix + suffix;
+    nb -= prefix + suffix;
+    for (i = 0;i < na && i < nb && !ctx->failed;i++,a = a->next,b = b->next)
+    {
+        if (cJSON_Compare(a,b,1))
+        {
+            continue;
+        }
+        old = patch_push_index(ctx,prefix + i);
+        patch_diff(ctx,a,b);
+        patch_pop(ctx,old);
+    }
+    // 从后往前删除，前面元素的下标不受影响
+    for (i = na;i > nb && !ctx->failed;i--)
+    {
+        old = patch_push_index(ctx,prefix + i - 1);
+        patch_emit(ctx,"remove",0);
+        patch_pop(ctx,old);
+    }
+    for (;i < nb && !ctx->failed;i++,b = b->next)
+    {
+        old = patch_push_index(ctx,prefix + i);
+        patch_emit(ctx,"add",b);
+        patch_pop(ctx,old);
+    }
+}
+
+// 两边都缓存了哈希时，不同的子树由cJSON_Compare直接判定，相同的子树比较一遍确认（共享子结点链表时不用比较）
+static void patch_diff(patch_context* ctx,cJSON* from,cJSON* to){
+    if (ctx->failed || cJSON_Compare(from,to,1))
+    {
+        return;
+    }
+    if ((from->type & 255) == cJSON_Object && (to->type & 255) == cJSON_Object)
+    {
+        patch_diff_object(ctx,from,to);
+    }else if ((from->type & 255) == cJSON_Array && (to->type & 255) == cJSON_Array)
+    {
+        patch_diff_array(ctx,from,to);
+    }else{
+        patch_emit(ctx,"replace",to);
+    }
+}
+
+cJSON* cJSON_CreatePatch(cJSON* from,cJSON* to){
+    patch_context ctx;
+    hash_marks marks;
+    if (!from || !to)
+    {
+        return 0;
+    }
+    memset(&ctx,0,sizeof(ctx));
+    ctx.patch = cJSON_CreateArray();
+    if (!ctx.patch)
+    {
+        return 0;
+    }
+    memset(&marks,0,sizeof(marks));
+    hash_tree(from,1,&marks);
+    hash_tree(to,1,&marks);
+    patch_diff(&ctx,from,to);
+    hash_unmark(&marks);
+    if (ctx.path)
+    {
+        mem_free(ctx.path,ctx.size,MEM_OTHER);
+    }
+    if (ctx.failed)
+    {
+        cJSON_Delete(ctx.patch);
+        return 0;
+    }
+    return ctx.patch;
+}
+
+// JSON Pointer中的一段[seg,seg+len)，没有解码
+typedef struct
+{
+    const char* seg;
+    size_t len;
+} pointer_segment;
+
+// 未解码的一段和键名是否相同
+static int pointer_equal(pointer_segment s,const char* key){
+    size_t i;
+    for (i = 0;i < s.len;i++,key++)
+    {
+        if (s.seg[i] == '~' && i + 1 < s.len && (s.seg[i + 1] == '0' || s.seg[i + 1] == '1'))
+        {
+            if (*key != (s.seg[++i] == '0' ? '~' : '/'))
+            {
+                return 0;
+            }
+        }else if (*key != s.seg[i])
+        {
+            return 0;
+        }
+    }
+    return !*key;
+}
+
+// 解码到out中，out至少要有len+1字节
+static void pointer_decode(pointer_segment s,char* out){
+    size_t i;
+    for (i = 0;i < s.len;i++)
+    {
+        if (s.seg[i] == '~' && i + 1 < s.len && (s.seg[i + 1] == '0' || s.seg[i + 1] == '1'))
+        {
+            *out++ = s.seg[++i] == '0' ? '~' : '/';
+        }else{
+            *out++ = s.seg[i];
+        }
+    }
+    *out = 0;
+}
+
+// 数组下标：不带前导0的十进制数，"-"和其它写法返回-1
+static int pointer_index(pointer_segment s){
+    size_t i;
+    int index = 0;
+    if (!s.len || (s.len > 1 && s.seg[0] == '0') || s.len > 9)
+    {
+        return -1;
+    }
+    for (i = 0;i < s.len;i++)
+    {
+        if (s.seg[i] < '0' || s.seg[i] > '9')
+        {
+            return -1;
+        }
+        index = index * 10 + s.seg[i] - '0';
+    }
+    return index;
+}
+
+// 容器中这一段对应的子结点，*index得到它在链表中的位置
+static cJSON* pointer_child(cJSON* container,pointer_segment s,int* index){
+    cJSON* c;
+    int i = 0;
+    int want = -1;
+    if ((container->type & 255) == cJSON_Array)
+    {
+        want = pointer_index(s);
+        if (want < 0)
+        {
+            return 0;
+        }
+    }else if ((container->type & 255) != cJSON_Object)
+    {
+        return 0;
+    }
+    for (c = container->child;c;c = c->next,i++)
+    {
+        if (want >= 0 ? i == want : pointer_equal(s,member_key(c)))
+        {
+            *index = i;
+            return c;
+        }
+    }
+    return 0;
+}
+
+// 找到path所指位置的父容器，*last得到最后一段；path为""时返回0，表示根结点本身
+// 要修改时一路复制共享的链表（同时清除缓存的哈希），父容器本身也是；找不到或格式错误时*bad为1
+static cJSON* pointer_parent(cJSON* root,const char* path,pointer_segment* last,int writable,int* bad){
+    cJSON* node = root;
+    const char* end;
+    int index;
+    *bad = 0;
+    if (!*path)
+    {
+        return 0;
+    }
+    if (*path != '/')
+    {
+        *bad = 1;
+        return 0;
+    }
+    while (1)
+    {
+        path++;
+        end = strchr(path,'/');
+        last->seg = path;
+        last->len = end ? (size_t)(end - path) : strlen(path);
+        if (writable && !cJSON_Unshare(node))
+        {
+            *bad = 1;
+            return 0;
+        }
+        if (!end)
+        {
+            if ((node->type & 255) != cJSON_Array && (node->type & 255) != cJSON_Object)
+            {
+                *bad = 1;
+                return 0;
+            }
+            return node;
+        }
+        node = pointer_child(node,*last,&index);
+        if (!node)
+        {
+            *bad = 1;
+            return 0;
+        }
+        path = end;
+    }
+}
+
+// 读取path所指的结点，不存在时返回0
+static cJSON* pointer_get(cJSON* root,const char* path){
+    pointer_segment last;
+    cJSON* parent;
+    int bad;
+    int index;
+    parent = pointer_parent(root,path,&last,0,&bad);
+    if (bad)
+    {
+        return 0;
+    }
+    return parent ? pointer_child(parent,last,&index) : root;
+}
+
+// 去掉结点原来的键，准备挂到数组里或者换一个键
+static void node_clear_key(cJSON* item){
+    if (item->string && !(item->type & cJSON_StringIsConst))
+    {
+        node_free_string(item,item->string);
+    }
+    item->string = 0;
+    item->type &= ~cJSON_StringIsConst;
+}
+
+// 把结点的键换成string，失败时结点保留原来的键
+static int node_rename(cJSON* item,const char* string){
+    char* old = item->string;
+    int flags = item->type & cJSON_StringIsConst;
+    item->string = 0;
+    if (!node_set_key(item,string))
+    {
+        // 申请失败时没有写过inlinebuf，原来的键还在
+        item->string = old;
+        item->type = (item->type & ~cJSON_StringIsConst) | flags;
+        return 0;
+    }
+    if (old && !(flags & cJSON_StringIsConst))
+    {
+        node_free_string(item,old);
+    }
+    return 1;
+}
+
+// 用item的类型、值和子结点替换root的，root保留自己的键和标记（例如文件映射），item被释放
+// 根结点的地址交给了调用者，所以替换整个文档只能这样原地进行
+static int node_replace_contents(cJSON* root,cJSON* item){
+    char* str = 0;
+    if (node_valuestring(item) && !(item->type & cJSON_IsReference))
+    {
+        str = item->valuestring;
+#ifdef CJSON_COMPACT
+        // 存放在item内部的字符串要复制出来
+        if (cJSON_IsInline(item,str))
+        {
+            str = (char*)mem_alloc(strlen(item->valuestring) + 1,MEM_STRING);
+            if (!str)
+            {
+                return 0;
+            }
+            strcpy(str,item->valuestring);
+        }else{
+            item->valuestring = 0;
+        }
+#else
+        item->valuestring = 0;
+#endif
+    }else if (node_valuestring(item))
+    {
+        str = item->valuestring;
+    }
+    // 释放root原来的值和子结点
+    if (!(root->type & cJSON_IsReference))
+    {
+        if (node_valuestring(root))
+        {
+            node_free_string(root,root->valuestring);
+        }
+        root->valuestring = 0;
+        if (root->child && share_release(root->child))
+        {
+            cJSON_Delete(root->child);
+        }
+    }
+    root->type = (item->type & (255 | cJSON_IsReference)) | (root->type & (cJSON_StringIsConst | cJSON_OwnsMapping));
+    root->child = item->child;
+    root->valuedoint = item->valuedoint;
+    if (str)
+    {
+        root->valuestring = str;
+    }else{
+        root->valuedouble = item->valuedouble;
+    }
+    item->child = 0;
+    item->type = cJSON_NULL | (item->type & cJSON_StringIsConst);
+    cJSON_Delete(item);
+    return 1;
+}
+
+// 把item放到path所指的位置：数组中插入（"-"表示末尾），对象中添加或替换同名成员
+// replace为1时位置上必须已经有结点；成功后item归树所有，失败时仍归调用者，键也没有改变
+static int patch_put(cJSON* root,const char* path,cJSON* item,int replace){
+    pointer_segment last;
+    cJSON* parent;
+    cJSON* old;
+    char local[64];
+    char* key = local;
+    int bad;
+    int index = -1;
+    int ok = 1;
+    parent = pointer_parent(root,path,&last,1,&bad);
+    if (bad)
+    {
+        return 0;
+    }
+    if (!parent)
+    {
+        return node_replace_contents(root,item);
+    }
+    old = pointer_child(parent,last,&index);
+    if (replace && !old)
+    {
+        return 0;
+    }
+    if ((parent->type & 255) == cJSON_Array)
+    {
+        if (!old && !(last.len == 1 && last.seg[0] == '-') && pointer_index(last) != cJSON_GetArraySize(parent))
+        {
+            return 0;
+        }
+        node_clear_key(item);
+        if (old && replace)
+        {
+            cJSON_ReplaceItemInArray(parent,index,item);
+        }else if (old)
+        {
+            cJSON_InsertItemInArray(parent,index,item);
+        }else{
+            cJSON_AddItemToArray(parent,item);
+        }
+        return 1;
+    }
+    if (last.len >= sizeof(local))
+    {
+        key = (char*)mem_alloc(last.len + 1,MEM_OTHER);
+        if (!key)
+        {
+            return 0;
+        }
+    }
+    pointer_decode(last,key);
+    if (!node_rename(item,key))
+    {
+        ok = 0;
+    }else if (old)
+    {
+        cJSON_ReplaceItemInArray(parent,index,item);
+    }else{
+        // 父容器已经复制过共享的链表，下面不会再申请内存，不会失败
+        cJSON_AddItemToArray(parent,item);
+    }
+    if (key != local)
+    {
+        mem_free(key,last.len + 1,MEM_OTHER);
+    }
+    return ok;
+}
+
+// 从树中取下path所指的结点，不存在或者是根结点时返回0；parent和index是它原来的位置
+static cJSON* patch_take(cJSON* root,const char* path,cJSON** parent,int* index){
+    pointer_segment last;
+    int bad;
+    *parent = pointer_parent(root,path,&last,1,&bad);
+    if (!*parent || !pointer_child(*parent,last,index))
+    {
+        return 0;
+    }
+    return cJSON_DetachItemFromArray(*parent,*index);
+}
+
+// 执行一个操作，成功返回1
+static int patch_apply_op(cJSON* object,cJSON* op){
+    const char* name = cJSON_GetStringValue(cJSON_GetObjectItem(op,"op"));
+    const char* path = cJSON_GetStringValue(cJSON_GetObjectItem(op,"path"));
+    const char* from = cJSON_GetStringValue(cJSON_GetObjectItem(op,"from"));
+    cJSON* value = cJSON_GetObjectItem(op,"value");
+    cJSON* item = 0;
+    cJSON* source = 0;
+    int index = 0;
+    size_t len;
+    if (!name || !path)
+    {
+        return 0;
+    }
+    if (!strcmp(name,"test"))
+    {
+        item = pointer_get(object,path);
+        return item && value && cJSON_Compare(item,value,1);
+    }
+    if (!strcmp(name,"remove"))
+    {
+        item = patch_take(object,path,&source,&index);
+        cJSON_Delete(item);
+        return item != 0;
+    }
+    if (!strcmp(name,"add") || !strcmp(name,"replace"))
+    {
+        if (!value)
+        {
+            return 0;
+        }
+        // 补丁中的值以写时复制的方式放进目标，不复制整个值
+        item = cJSON_DuplicateShared(value);
+    }else if (!strcmp(name,"copy") && from)
+    {
+        item = pointer_get(object,from);
+        item = item ? cJSON_DuplicateShared(item) : 0;
+    }else if (!strcmp(name,"move") && from)
+    {
+        // 不能移动到自己的子结点中
+        len = strlen(from);
+        if (!strncmp(from,path,len) && path[len] == '/')
+        {
+            return 0;
+        }
+        if (!strcmp(from,path))
+        {
+            return pointer_get(object,from) != 0;
+        }
+        item = patch_take(object,from,&source,&index);
+    }else{
+        return 0;
+    }
+    if (!item)
+    {
+        return 0;
+    }
+    if (!patch_put(object,path,item,!strcmp(name,"replace")))
+    {
+        // 移动的目标位置不存在时放回原处，失败的操作不丢数据；取下时父容器已经复制过共享的链表，放回不会失败
+        if (source)
+        {
+            cJSON_InsertItemInArray(source,index,item);
+        }else{
+            cJSON_Delete(item);
+        }
+        return 0;
+    }
+    return 1;
+}
+
+int cJSON_ApplyPatch(cJSON* object,cJSON* patch){
+    cJSON* op;
+    if (!object || !patch || (patch->type & 255) != cJSON_Array)
+    {
+        return 0;
+    }
+    for (op = patch->child;op;op = op->next)
+    {
+        if (!patch_apply_op(object,op))
+        {
+            ep = cJSON_GetStringValue(cJSON_GetObjectItem(op,"path"));
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* JSON Merge Patch（RFC 7386） */
+
+// 去掉对象中值为null的成员，对象中的对象也一样（数组整体作为值，不处理）
+// 补丁中的对象放进目标中没有对象的位置时就是这样合并的结果
+static int merge_strip_nulls(cJSON* object){
+    cJSON* c;
+    cJSON* next;
+    if (!cJSON_Unshare(object))
+    {
+        return 0;
+    }
+    for (c = object->child;c;c = next)
+    {
+        next = c->next;
+        if ((c->type & 255) == cJSON_NULL)
+        {
+            node_unlink(object,c);
+            cJSON_Delete(c);
+        }else if ((c->type & 255) == cJSON_Object && !merge_strip_nulls(c))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 把补丁对象patch合并进目标对象target，patch的成员直接移动到target中，patch最后被释放
+// target的成员按键名查找，宽对象建哈希表；取下和替换成员时同步更新查找表
+static int merge_apply(cJSON* target,cJSON* patch){
+    member_index ix;
+    cJSON* v;
+    cJSON* t;
+    cJSON* tail = 0;
+    int ok = cJSON_Unshare(target) && cJSON_Unshare(patch);
+    member_index_init(&ix,target);
+    while (ok && patch->child)
+    {
+        v = patch->child;
+        node_unlink(patch,v);
+        t = (cJSON*)member_find(&ix,member_key(v));
+        if ((v->type & 255) == cJSON_NULL)
+        {
+            if (t)
+            {
+                tail = t == tail ? t->prev : tail;
+                member_index_remove(&ix,t);
+                node_unlink(target,t);
+                cJSON_Delete(t);
+            }
+            cJSON_Delete(v);
+        }else if ((v->type & 255) == cJSON_Object && t && (t->type & 255) == cJSON_Object)
+        {
+            ok = merge_apply(t,v);
+        }else{
+            ok = (v->type & 255) != cJSON_Object || merge_strip_nulls(v);
+            if (ok && t)
+            {
+                // 原地换掉成员的内容，位置、键和查找表都不变
+                ok = node_replace_contents(t,v);
+            }else if (ok)
+            {
+                // 第一次添加时才找尾部
+                for (tail = tail ? tail : target->child;tail && tail->next;tail = tail->next)
+                {
+                }
+                if (tail)
+                {
+                    suffix_object(tail,v);
+                }else{
+                    target->child = v;
+                }
+                tail = v;
+                member_index_add(&ix,v);
+                v = 0;
+            }
+            if (!ok)
+            {
+                cJSON_Delete(v);
+            }
+        }
+    }
+    member_index_free(&ix);
+    cJSON_Delete(patch);
+    return ok;
+}
+
+int cJSON_ApplyMergePatch(cJSON* target,cJSON* patch){
+    if (!target || !patch)
+    {
+        cJSON_Delete(patch);
+        return 0;
+    }
+    if ((patch->type & 255) == cJSON_Object && (target->type & 255) == cJSON_Object)
+    {
+        return merge_apply(target,patch);
+    }
+    // 补丁不是对象时整个替换目标；目标不是对象时相当于合并进空对象
+    if (((patch->type & 255) == cJSON_Object && !merge_strip_nulls(patch)) || !node_replace_contents(target,patch))
+    {
+        cJSON_Delete(patch);
+        return 0;
+    }
+    return 1;
+}
+
+// 把item以键key接到对象的尾部
+static int merge_append(cJSON* object,cJSON** tail,cJSON* item,const char* key){
+    if (!item)
+    {
+        return 0;
+    }
+    if (!item->string && !node_set_key(item,key))
+    {
+        cJSON_Delete(item);
+        return 0;
+    }
+    if (*tail)
+    {
+        suffix_object(*tail,item);
+    }else{
+        object->child = item;
+    }
+    *tail = item;
+    return 1;
+}
+
+// 两个不相等的对象之间的合并补丁
+static cJSON* merge_diff(cJSON* from,cJSON* to){
+    member_index in_to;
+    member_index in_from;
+    cJSON* patch = cJSON_CreateObject();
+    cJSON* tail = 0;
+    cJSON* c;
+    cJSON* f;
+    cJSON* item;
+    int ok = patch != 0;
+    member_index_init(&in_to,to);
+    member_index_init(&in_from,from);
+    for (c = from->child;c && ok;c = c->next)
+    {
+        if (!member_find(&in_to,member_key(c)))
+        {
+            ok = merge_append(patch,&tail,cJSON_CreateNull(),member_key(c));
+        }
+    }
+    for (c = to->child;c && ok;c = c->next)
+    {
+        f = (cJSON*)member_find(&in_from,member_key(c));
+        if (f && cJSON_Compare(f,c,1))
+        {
+            continue;
+        }
+        if (f && (f->type & 255) == cJSON_Object && (c->type & 255) == cJSON_Object)
+        {
+            item = merge_diff(f,c);
+        }else{
+            // 写时复制的副本，和to共享子结点
+            item = cJSON_DuplicateShared(c);
+            if (item)
+            {
+                item->type &= ~cJSON_HashValid;
+            }
+        }
+        ok = merge_append(patch,&tail,item,member_key(c));
+    }
+    member_index_free(&in_to);
+    member_index_free(&in_from);
+    if (!ok)
+    {
+        cJSON_Delete(patch);
+        return 0;
+    }
+    return patch;
+}
+
+cJSON* cJSON_CreateMergePatch(cJSON* from,cJSON* to){
+    cJSON* patch;
+    hash_marks marks;
+    if (!from || !to)
+    {
+        return 0;
+    }
+    if ((from->type & 255) == cJSON_Object && (to->type & 255) == cJSON_Object)
+    {
+        memset(&marks,0,sizeof(marks));
+        hash_tree(from,1,&marks);
+        hash_tree(to,1,&marks);
+        patch = merge_diff(from,to);
+        hash_unmark(&marks);
+        return patch;
+    }
+    patch = cJSON_DuplicateShared(to);
+    if (patch)
+    {
+        node_clear_key(patch);
+    }
+    return patch;
+}
+
+/* 二进制编码：CBOR（RFC 8949）和MessagePack */
+
+// 二进制编码时使用的输出缓冲区
+typedef struct
+{
+    unsigned char* data;
+    size_t length;
+    size_t offset;
+    // 当前容器的嵌套层数，编码和解码用同一个上限，编码出的结果总能被解码
+    int depth;
+} binbuffer;
+
+// 二进制解码时的输入状态
+typedef struct
+{
+    unsigned char* data;
+    size_t length;
+    size_t offset;
+    // 非0时字符串在输入缓冲区中原地存放，不申请内存
+    int insitu;
+    int depth;
+} binreader;
+
+// 二进制解码允许的最大嵌套层数，防止恶意输入耗尽栈空间
+#define CJSON_BINARY_NESTING_LIMIT 1000
+
+// 保证缓冲区还能写入needed个字节，返回写入位置
+static unsigned char* bin_ensure(binbuffer* b,size_t needed){
+    unsigned char* newdata;
+    size_t newsize;
+    if (!b->data)
+    {
+        return 0;
+    }
+    if (b->offset + needed <= b->length)
+    {
+        return b->data + b->offset;
+    }
+    newsize = b->length * 2;
+    while (newsize < b->offset + needed)
+    {
+        newsize *= 2;
+    }
+    newdata = (unsigned char*)mem_realloc(b->data,b->length,newsize,MEM_PRINT);
+    if (!newdata)
+    {
+        mem_free(b->data,b->length,MEM_PRINT);
+        b->data = 0;
+        return 0;
+    }
+    b->data = newdata;
+    b->length = newsize;
+    return b->data + b->offset;
+}
+
+// 以大端序写入size字节的整数
+static int bin_put(binbuffer* b,unsigned char lead,unsigned long long v,int size){
+    unsigned char* out = bin_ensure(b,(size_t)size + 1);
+    int i;
+    if (!out)
+    {
+        return 0;
+    }
+    *out++ = lead;
+    for (i = size - 1;i >= 0;i--)
+    {
+        *out++ = (unsigned char)(v >> (i * 8));
+    }
+    b->offset += (size_t)size + 1;
+    return 1;
+}
+
+static int bin_put_bytes(binbuffer* b,const char* str,size_t len){
+    unsigned char* out = bin_ensure(b,len);
+    if (!out)
+    {
+        return 0;
+    }
+    memcpy(out,str,len);
+    b->offset += len;
+    return 1;
+}
+
+// 数值是否可以作为整数编码，是的话通过v返回
+static int number_is_integer(double d,long long* v){
+    if (d != floor(d) || d < -9223372036854775808.0 || d >= 9223372036854775808.0)
+    {
+        return 0;
+    }
+    *v = (long long)d;
+    return 1;
+}
+
+static int count_children(const cJSON* item){
+    const cJSON* c;
+    int n = 0;
+    for (c = item->child;c;c = c->next)
+    {
+        n++;
+    }
+    return n;
+}
+
+// CBOR的数据项头部：高3位是主类型，低5位是参数或者参数的字节数
+static int cbor_put_head(binbuffer* b,int major,unsigned long long arg){
+    unsigned char m = (unsigned char)(major << 5);
+    if (arg < 24)
+    {
+        return bin_put(b,(unsigned char)(m | arg),0,0);
+    }else if (arg <= 0xFF)
+    {
+        return bin_put(b,m | 24,arg,1);
+    }else if (arg <= 0xFFFF)
+    {
+        return bin_put(b,m | 25,arg,2);
+    }else if (arg <= 0xFFFFFFFFULL)
+    {
+        return bin_put(b,m | 26,arg,4);
+    }
+    return bin_put(b,m | 27,arg,8);
+}
+
+static int cbor_put_string(binbuffer* b,const char* str){
+    size_t len = str ? strlen(str) : 0;
+    return cbor_put_head(b,3,len) && bin_put_bytes(b,str,len);
+}
+
+static int print_cbor(const cJSON* item,binbuffer* b){
+    const cJSON* c;
+    long long v;
+    double d;
+    float f;
+    union { double d; unsigned long long u; } dbits;
+    union { float f; unsigned int u; } fbits;
+    switch (item->type & 255)
+    {
+    case cJSON_False:
+        return bin_put(b,0xF4,0,0);
+    case cJSON_True:
+        return bin_put(b,0xF5,0,0);
+    case cJSON_NULL:
+        return bin_put(b,0xF6,0,0);
+    case cJSON_Number:
+        d = item->valuedouble;
+        // 整数直接用CBOR的整数类型，负数n编码为-1-n
+        if (number_is_integer(d,&v))
+        {
+            return v >= 0 ? cbor_put_head(b,0,(unsigned long long)v) : cbor_put_head(b,1,(unsigned long long)(-1 - v));
+        }
+        // 能用单精度精确表示的浮点数只占5个字节
+        f = (float)d;
+        if ((double)f == d)
+        {
+            fbits.f = f;
+            return bin_put(b,0xFA,fbits.u,4);
+        }
+        dbits.d = d;
+        return bin_put(b,0xFB,dbits.u,8);
+    case cJSON_String:
+        return cbor_put_string(b,item->valuestring);
+    case cJSON_Array:
+        if (++b->depth > CJSON_BINARY_NESTING_LIMIT || !cbor_put_head(b,4,(unsigned long long)count_children(item)))
+        {
+            return 0;
+        }
+        for (c = item->child;c;c = c->next)
+        {
+            if (!print_cbor(c,b))
+            {
+                return 0;
+            }
+        }
+        b->depth--;
+        return 1;
+    case cJSON_Object:
+        if (++b->depth > CJSON_BINARY_NESTING_LIMIT || !cbor_put_head(b,5,(unsigned long long)count_children(item)))
+        {
+            return 0;
+        }
+        for (c = item->child;c;c = c->next)
+        {
+            if (!cbor_put_string(b,c->string) || !print_cbor(c,b))
+            {
+                return 0;
+            }
+        }
+        b->depth--;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int msgpack_put_string(binbuffer* b,const char* str){
+    size_t len = str ? strlen(str) : 0;
+    int ok;
+    if (len < 32)
+    {
+        ok = bin_put(b,(unsigned char)(0xA0 | len),0,0);
+    }else if (len <= 0xFF)
+    {
+        ok = bin_put(b,0xD9,len,1);
+    }else if (len <= 0xFFFF)
+    {
+        ok = bin_put(b,0xDA,len,2);
+    }else{
+        ok = bin_put(b,0xDB,len,4);
+    }
+    return ok && bin_put_bytes(b,str,len);
+}
+
+// MessagePack的数组和map头部，fix表示能放进首字节的最大个数
+static int msgpack_put_container(binbuffer* b,unsigned char fix,unsigned char lead16,unsigned char limit,int n){
+    if (n < limit)
+    {
+        return bin_put(b,(unsigned char)(fix | n),0,0);
+    }else if (n <= 0xFFFF)
+    {
+        return bin_put(b,lead16,(unsigned long long)n,2);
+    }
+    return bin_put(b,(unsigned char)(lead16 + 1),(unsigned long long)n,4);
+}
+
+static int print_msgpack(const cJSON* item,binbuffer* b){
+    const cJSON* c;
+    long long v;
+    double d;
+    float f;
+    union { double d; unsigned long long u; } dbits;
+    union { float f; unsigned int u; } fbits;
+    switch (item->type & 255)
+    {
+    case cJSON_False:
+        return bin_put(b,0xC2,0,0);
+    case cJSON_True:
+        return bin_put(b,0xC3,0,0);
+    case cJSON_NULL:
+        return bin_put(b,0xC0,0,0);
+    case cJSON_Number:
+        d = item->valuedouble;
+        if (number_is_integer(d,&v))
+        {
+            // 选择能放下这个整数的最短编码
+            if (v >= 0)
+            {
+                if (v < 128) return bin_put(b,(unsigned char)v,0,0);
+                if (v <= 0xFF) return bin_put(b,0xCC,(unsigned long long)v,1);
+                if (v <= 0xFFFF) return bin_put(b,0xCD,(unsigned long long)v,2);
+                if (v <= 0xFFFFFFFFLL) return bin_put(b,0xCE,(unsigned long long)v,4);
+                return bin_put(b,0xCF,(unsigned long long)v,8);
+            }
+            if (v >= -32) return bin_put(b,(unsigned char)(0xE0 | (v + 32)),0,0);
+            if (v >= -128) return bin_put(b,0xD0,(unsigned long long)v,1);
+            if (v >= -32768) return bin_put(b,0xD1,(unsigned long long)v,2);
+            if (v >= -2147483647LL - 1) return bin_put(b,0xD2,(unsigned long long)v,4);
+            return bin_put(b,0xD3,(unsigned long long)v,8);
+        }
+        f = (float)d;
+        if ((double)f == d)
+        {
+            fbits.f = f;
+            return bin_put(b,0xCA,fbits.u,4);
+        }
+        dbits.d = d;
+        return bin_put(b,0xCB,dbits.u,8);
+    case cJSON_String:
+        return msgpack_put_string(b,item->valuestring);
+    case cJSON_Array:
+        if (++b->depth > CJSON_BINARY_NESTING_LIMIT || !msgpack_put_container(b,0x90,0xDC,16,count_children(item)))
+        {
+            return 0;
+        }
+        for (c = item->child;c;c = c->next)
+        {
+            if (!print_msgpack(c,b))
+            {
+                return 0;
+            }
+        }
+        b->depth--;
+        return 1;
+    case cJSON_Object:
+        if (++b->depth > CJSON_BINARY_NESTING_LIMIT || !msgpack_put_container(b,0x80,0xDE,16,count_children(item)))
+        {
+            return 0;
+        }
+        for (c = item->child;c;c = c->next)
+        {
+            if (!msgpack_put_string(b,c->string) || !print_msgpack(c,b))
+            {
+                return 0;
+            }
+        }
+        b->depth--;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static unsigned char* print_binary(const cJSON* item,size_t* len,int (*print_fn)(const cJSON*,binbuffer*)){
+    binbuffer b;
+    if (!item)
+    {
+        return 0;
+    }
+    b.length = 256;
+    b.offset = 0;
+    b.depth = 0;
+    b.data = (unsigned char*)mem_alloc(b.length,MEM_PRINT);
+    if (!b.data)
+    {
+        return 0;
+    }
+    if (!print_fn(item,&b))
+    {
+        if (b.data)
+        {
+            mem_free(b.data,b.length,MEM_PRINT);
+        }
+        return 0;
+    }
+    mem_account(MEM_PRINT,b.length,0);
+    if (len)
+    {
+        *len = b.offset;
+    }
+    return b.data;
+}
+
+unsigned char* cJSON_PrintCBOR(const cJSON* item,size_t* len){
+    return print_binary(item,len,print_cbor);
+}
+
+unsigned char* cJSON_PrintMsgPack(const cJSON* item,size_t* len){
+    return print_binary(item,len,print_msgpack);
+}
+
+// 读取size字节的大端整数
+static int bin_get(binreader* r,int size,unsigned long long* v){
+    int i;
+    if (r->length - r->offset < (size_t)size)
+    {
+        return 0;
+    }
+    *v = 0;
+    for (i = 0;i < size;i++)
+    {
+        *v = (*v << 8) | r->data[r->offset++];
+    }
+    return 1;
+}
+
+// 设置数值结点，valuedoint按int的范围截断
+static void node_set_number(cJSON* item,double d){
+    item->type = cJSON_Number;
+    item->valuedouble = d;
+    item->valuedoint = d >= INT_MAX ? INT_MAX : (d <= INT_MIN ? INT_MIN : (int)d);
+}
+
+// 读取长度为len的字符串，iskey为1时作为item的键，否则作为item的值
+static int bin_get_string(binreader* r,cJSON* item,size_t len,int iskey){
+    char* str;
+    if (r->length - r->offset < len)
+    {
+        return 0;
+    }
+    if (r->insitu)
+    {
+        // 字符串前面至少有一个已经读过的头部字节：整体前移一个字节，空出来的最后一个字节写'\0'
+        str = (char*)r->data + r->offset - 1;
+        memmove(str,r->data + r->offset,len);
+        str[len] = 0;
+    }else if (iskey && intern_pool)
+    {
+        str = intern_string(intern_pool,(const char*)r->data + r->offset,len);
+    }else{
+        str = node_alloc_string(item,iskey ? node_valuestring(item) : item->string,len + 1);
+        if (str)
+        {
+            memcpy(str,r->data + r->offset,len);
+            str[len] = 0;
+            // 字符串中间可能有'\0'，统计按释放时看到的长度计算
+            if (mem_stats)
+            {
+#ifdef CJSON_COMPACT
+                if (!cJSON_IsInline(item,str))
+#endif
+                mem_account(MEM_STRING,len + 1,strlen(str) + 1);
+            }
+        }
+    }
+    if (!str)
+    {
+        return 0;
+    }
+    r->offset += len;
+    if (iskey)
+    {
+        item->string = str;
+    }else{
+        item->valuestring = str;
+        item->type = r->insitu ? (cJSON_String | cJSON_IsReference) : cJSON_String;
+    }
+    return 1;
+}
+
+// 解码n个子结点挂到item下，ismap为1时每个子结点前面有一个字符串键
+static int bin_get_children(binreader* r,cJSON* item,unsigned long long n,int ismap,int (*parse_fn)(binreader*,cJSON*,int)){
+    cJSON *child,*prev = 0;
+    // 原地解码或者来自字符串池的键不需要释放
+    int keyflag = ismap && (r->insitu || intern_pool) ? cJSON_StringIsConst : 0;
+    // 每个子结点至少占一个字节，先排除明显错误的个数，防止申请大量结点
+    if (n > r->length - r->offset)
+    {
+        return 0;
+    }
+    if (++r->depth > CJSON_BINARY_NESTING_LIMIT)
+    {
+        return 0;
+    }
+    while (n--)
+    {
+        child = cJSON_New_Item();
+        if (!child)
+        {
+            return 0;
+        }
+        if (prev)
+        {
+            suffix_object(prev,child);
+        }else{
+            item->child = child;
+        }
+        prev = child;
+        if (ismap && !parse_fn(r,child,1))
+        {
+            return 0;
+        }
+        // 键解码成功后立即标记：值解码失败时cJSON_Delete也不能释放这个键；值解码会重写type，之后再标记一次
+        child->type |= keyflag;
+        if (!parse_fn(r,child,0))
+        {
+            child->type |= keyflag;
+            return 0;
+        }
+        child->type |= keyflag;
+    }
+    r->depth--;
+    return 1;
+}
+
+// 半精度浮点数转换为double
+static double half_to_double(unsigned int h){
+    int e = (h >> 10) & 0x1F;
+    double m = h & 0x3FF;
+    double v = e == 0 ? ldexp(m,-24) : (e == 31 ? (m ? NAN : INFINITY) : ldexp(m + 1024,e - 25));
+    return (h & 0x8000) ? -v : v;
+}
+
+// 解码一个CBOR数据项，iskey为1时只接受文本字符串并作为item的键
+static int parse_cbor(binreader* r,cJSON* item,int iskey){
+    unsigned long long arg = 0;
+    int major,info;
+    union { double d; unsigned long long u; } dbits;
+    union { float f; unsigned int u; } fbits;
+    // 标签（major为6）：忽略标签本身，解码被标记的数据项。连续的标签在这里循环跳过，不递归，也不占嵌套层数
+    do
+    {
+        if (r->offset >= r->length)
+        {
+            return 0;
+        }
+        major = r->data[r->offset] >> 5;
+        info = r->data[r->offset] & 0x1F;
+        r->offset++;
+        // 参数：小于24时就在头部，24~27分别跟随1、2、4、8个字节；不支持不定长编码
+        if (info >= 24 && info <= 27)
+        {
+            if (!bin_get(r,1 << (info - 24),&arg))
+            {
+                return 0;
+            }
+        }else if (info < 24)
+        {
+            arg = (unsigned long long)info;
+        }else{
+            return 0;
+        }
+    } while (major == 6);
+    if (iskey && major != 3)
+    {
+        return 0;
+    }
+    switch (major)
+    {
+    case 0:
+        node_set_number(item,(double)arg);
+        return 1;
+    case 1:
+        node_set_number(item,-1.0 - (double)arg);
+        return 1;
+    case 2:
+    case 3:
+        // JSON没有字节串，和文本字符串一样处理
+        return bin_get_string(r,item,(size_t)arg,iskey);
+    case 4:
+        item->type = cJSON_Array;
+        return bin_get_children(r,item,arg,0,parse_cbor);
+    case 5:
+        item->type = cJSON_Object;
+        return bin_get_children(r,item,arg,1,parse_cbor);
+    default:
+        switch (info)
+        {
+        case 20:
+            item->type = cJSON_False;
+            return 1;
+        case 21:
+            item->type = cJSON_True;
+            item->valuedoint = 1;
+            return 1;
+        case 22:
+        case 23:
+            item->type = cJSON_NULL;
+            return 1;
+        case 25:
+            node_set_number(item,half_to_double((unsigned int)arg));
+            return 1;
+        case 26:
+            fbits.u = (unsigned int)arg;
+            node_set_number(item,fbits.f);
+            return 1;
+        case 27:
+            dbits.u = arg;
+            node_set_number(item,dbits.d);
+            return 1;
+        default:
+            return 0;
+        }
+    }
+}
+
+// 解码一个MessagePack数据项，iskey为1时只接受字符串并作为item的键
+static int parse_msgpack(binreader* r,cJSON* item,int iskey){
+    unsigned long long v = 0;
+    unsigned char lead;
+    union { double d; unsigned long long u; } dbits;
+    union { float f; unsigned int u; } fbits;
+    if (r->offset >= r->length)
+    {
+        return 0;
+    }
+    lead = r->data[r->offset++];
+    // fixstr、str8/16/32，bin8/16/32按字符串处理
+    if ((lead & 0xE0) == 0xA0)
+    {
+        return bin_get_string(r,item,lead & 0x1F,iskey);
+    }
+    if ((lead >= 0xD9 && lead <= 0xDB) || (lead >= 0xC4 && lead <= 0xC6))
+    {
+        int size = (lead >= 0xD9) ? 1 << (lead - 0xD9) : 1 << (lead - 0xC4);
+        return bin_get(r,size,&v) && bin_get_string(r,item,(size_t)v,iskey);
+    }
+    if (iskey)
+    {
+        return 0;
+    }
+    if (lead < 0x80)
+    {
+        node_set_number(item,lead);
+        return 1;
+    }
+    if (lead >= 0xE0)
+    {
+        node_set_number(item,(signed char)lead);
+        return 1;
+    }
+    if ((lead & 0xF0) == 0x80)
+    {
+        item->type = cJSON_Object;
+        return bin_get_children(r,item,lead & 0x0F,1,parse_msgpack);
+    }
+    if ((lead & 0xF0) == 0x90)
+    {
+        item->type = cJSON_Array;
+        return bin_get_children(r,item,lead & 0x0F,0,parse_msgpack);
+    }
+    switch (lead)
+    {
+    case 0xC0:
+        item->type = cJSON_NULL;
+        return 1;
+    case 0xC2:
+        item->type = cJSON_False;
+        return 1;
+    case 0xC3:
+        item->type = cJSON_True;
+        item->valuedoint = 1;
+        return 1;
+    case 0xCA:
+        if (!bin_get(r,4,&v))
+        {
+            return 0;
+        }
+        fbits.u = (unsigned int)v;
+        node_set_number(item,fbits.f);
+        return 1;
+    case 0xCB:
+        if (!bin_get(r,8,&v))
+        {
+            return 0;
+        }
+        dbits.u = v;
+        node_set_number(item,dbits.d);
+        return 1;
+    case 0xCC:
+    case 0xCD:
+    case 0xCE:
+    case 0xCF:
+        if (!bin_get(r,1 << (lead - 0xCC),&v))
+        {
+            return 0;
+        }
+        node_set_number(item,(double)v);
+        return 1;
+    case 0xD0:
+        if (!bin_get(r,1,&v)) return 0;
+        node_set_number(item,(signed char)v);
+        return 1;
+    case 0xD1:
+        if (!bin_get(r,2,&v)) return 0;
+        node_set_number(item,(short)v);
+        return 1;
+    case 0xD2:
+        if (!bin_get(r,4,&v)) return 0;
+        node_set_number(item,(int)v);
+        return 1;
+    case 0xD3:
+        if (!bin_get(r,8,&v)) return 0;
+        node_set_number(item,(double)(long long)v);
+        return 1;
+    case 0xDC:
+    case 0xDD:
+        item->type = cJSON_Array;
+        return bin_get(r,lead == 0xDC ? 2 : 4,&v) && bin_get_children(r,item,v,0,parse_msgpack);
+    case 0xDE:
+    case 0xDF:
+        item->type = cJSON_Object;
+        return bin_get(r,lead == 0xDE ? 2 : 4,&v) && bin_get_children(r,item,v,1,parse_msgpack);
+    default:
+        // 扩展类型等JSON无法表示的数据
+        return 0;
+    }
+}
+
+static cJSON* parse_binary(unsigned char* data,size_t len,int insitu,int (*parse_fn)(binreader*,cJSON*,int)){
+    binreader r;
+    cJSON* c;
+    ep = 0;
+    if (!data)
+    {
+        return 0;
+    }
+    c = cJSON_New_Item();
+    if (!c)
+    {
+        return 0;
+    }
+    r.data = data;
+    r.length = len;
+    r.offset = 0;
+    r.insitu = insitu;
+    r.depth = 0;
+    // 整个输入必须恰好是一个数据项
+    if (!parse_fn(&r,c,0) || r.offset != r.length)
+    {
+        ep = (const char*)data + (r.offset < len ? r.offset : len);
+        cJSON_Delete(c);
+        return 0;
+    }
+    return c;
+}
+
+cJSON* cJSON_ParseCBOR(const unsigned char* data,size_t len){
+    return parse_binary((unsigned char*)data,len,0,parse_cbor);
+}
+
+cJSON* cJSON_ParseCBORInSitu(unsigned char* data,size_t len){
+    return parse_binary(data,len,1,parse_cbor);
+}
+
+cJSON* cJSON_ParseMsgPack(const unsigned char* data,size_t len){
+    return parse_binary((unsigned char*)data,len,0,parse_msgpack);
+}
+
+cJSON* cJSON_ParseMsgPackInSitu(unsigned char* data,size_t len){
+    return parse_binary(data,len,1,parse_msgpack);
+}
+
+/* 只读快照：可以直接mmap使用的二进制文档格式 */
+
+// 快照文件头，后面紧跟按层序排列的结点数组，再后面是字符串表
+typedef struct
+{
+    char magic[8];
+    unsigned int version;
+    // 写入0x01020304，读取时用来检查字节序是否一致
+    unsigned int byteorder;
+    // 整个快照的字节数
+    unsigned long long size;
+    unsigned long long nodes;
+} snapshot_header;
+
+// 快照中的结点。所有位置都是相对于结点自身的偏移，和快照被映射到的地址无关
+// 一个容器的子结点在结点数组中连续存放，所以按下标取数组元素是O(1)的
+struct cJSON_SnapNode
+{
+    int type;
+    // 容器的子结点个数，或者字符串的长度
+    unsigned int count;
+    // 结点在结点数组中的下标，由它找到文件头，访问时检查各个偏移不越出快照
+    unsigned long long index;
+    // 键字符串相对于本结点的偏移，没有键时为0
+    long long key;
+    union
+    {
+        // 容器：第一个子结点的相对偏移；字符串：字符串的相对偏移
+        long long offset;
+        double number;
+    } value;
+};
+
+#define SNAPSHOT_MAGIC "cJSONsnp"
+#define SNAPSHOT_VERSION 2
+
+static void snapshot_count(const cJSON* item,size_t* nodes,size_t* strings){
+    (*nodes)++;
+    if (item->string)
+    {
+        *strings += strlen(item->string) + 1;
+    }
+    if (node_valuestring(item))
+    {
+        *strings += strlen(item->valuestring) + 1;
+    }
+}
+
+// 统计树中的结点个数和字符串（包括'\0'）占用的字节数。和cJSON_MemoryUsage一样用自己的栈代替递归，
+// 任意深度的树都可以写成快照；栈申请失败时返回0
+static int snapshot_measure(const cJSON* item,size_t* nodes,size_t* strings){
+    const cJSON* local[32];
+    const cJSON** stack = local;
+    const cJSON** newstack;
+    size_t capacity = sizeof(local) / sizeof(local[0]);
+    size_t depth = 0;
+    const cJSON* c;
+    int ok = 1;
+    snapshot_count(item,nodes,strings);
+    if (item->child)
+    {
+        stack[depth++] = item->child;
+    }
+    while (depth && ok)
+    {
+        for (c = stack[--depth];c;c = c->next)
+        {
+            snapshot_count(c,nodes,strings);
+            if (!c->child)
+            {
+                continue;
+            }
+            if (depth == capacity)
+            {
+                newstack = (const cJSON**)mem_alloc(capacity * 2 * sizeof(cJSON*),MEM_OTHER);
+                if (!newstack)
+                {
+                    ok = 0;
+                    break;
+                }
+                memcpy(newstack,stack,depth * sizeof(cJSON*));
+                if (stack != local)
+                {
+                    mem_free((void*)stack,capacity * sizeof(cJSON*),MEM_OTHER);
+                }
+                stack = newstack;
+                capacity *= 2;
+            }
+            stack[depth++] = c->child;
+        }
+    }
+    if (stack != local)
+    {
+        mem_free((void*)stack,capacity * sizeof(cJSON*),MEM_OTHER);
+    }
+    return ok;
+}
+
+// 把字符串复制到字符串表中，返回它相对于结点n的偏移
+static long long snapshot_put_string(char* table,size_t* used,const struct cJSON_SnapNode* n,const char* str,unsigned int* len){
+    size_t l = strlen(str);
+    char* dst = table + *used;
+    memcpy(dst,str,l + 1);
+    *used += l + 1;
+    if (len)
+    {
+        *len = (unsigned int)l;
+    }
+    return (long long)(dst - (const char*)n);
+}
+
+unsigned char* cJSON_PrintSnapshot(const cJSON* item,size_t* len){
+    size_t nodes = 0,strings = 0,size,i,next = 1,used = 0;
+    unsigned char* out;
+    snapshot_header* h;
+    struct cJSON_SnapNode* arr;
+    const cJSON** src;
+    const cJSON* c;
+    char* table;
+    if (!item)
+    {
+        return 0;
+    }
+    if (!snapshot_measure(item,&nodes,&strings))
+    {
+        return 0;
+    }
+    size = sizeof(snapshot_header) + nodes * sizeof(struct cJSON_SnapNode) + strings;
+    out = (unsigned char*)mem_alloc(size,MEM_PRINT);
+    // 层序遍历时记录每个快照结点对应的原结点
+    src = (const cJSON**)mem_alloc(nodes * sizeof(cJSON*),MEM_OTHER);
+    if (!out || !src)
+    {
+        if (out) mem_free(out,size,MEM_PRINT);
+        if (src) mem_free((void*)src,nodes * sizeof(cJSON*),MEM_OTHER);
+        return 0;
+    }
+    memset(out,0,sizeof(snapshot_header) + nodes * sizeof(struct cJSON_SnapNode));
+    h = (snapshot_header*)out;
+    memcpy(h->magic,SNAPSHOT_MAGIC,8);
+    h->version = SNAPSHOT_VERSION;
+    h->byteorder = 0x01020304;
+    h->size = size;
+    h->nodes = nodes;
+    arr = (struct cJSON_SnapNode*)(out + sizeof(snapshot_header));
+    table = (char*)(arr + nodes);
+    src[0] = item;
+    for (i = 0;i < nodes;i++)
+    {
+        struct cJSON_SnapNode* n = arr + i;
+        n->type = src[i]->type & 255;
+        n->index = i;
+        if (src[i]->string)
+        {
+            n->key = snapshot_put_string(table,&used,n,src[i]->string,0);
+        }
+        switch (n->type)
+        {
+        case cJSON_Number:
+            n->value.number = src[i]->valuedouble;
+            break;
+        case cJSON_String:
+            n->value.offset = snapshot_put_string(table,&used,n,src[i]->valuestring ? src[i]->valuestring : "",&n->count);
+            break;
+        case cJSON_Array:
+        case cJSON_Object:
+            // 子结点放在当前已分配位置的后面，连续存放
+            n->value.offset = (long long)((arr + next) - n) * (long long)sizeof(struct cJSON_SnapNode);
+            for (c = src[i]->child;c;c = c->next)
+            {
+                src[next++] = c;
+                n->count++;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    mem_free((void*)src,nodes * sizeof(cJSON*),MEM_OTHER);
+    mem_account(MEM_PRINT,size,0);
+    if (len)
+    {
+        *len = size;
+    }
+    return out;
+}
+
+int cJSON_WriteSnapshot(const cJSON* item,const char* path){
+    size_t len = 0;
+    unsigned char* data = cJSON_PrintSnapshot(item,&len);
+    FILE* f;
+    int ok;
+    if (!data)
+    {
+        return 0;
+    }
+    f = fopen(path,"wb");
+    ok = f && fwrite(data,1,len,f) == len;
+    if (f && fclose(f) != 0)
+    {
+        ok = 0;
+    }
+    // 输出已经从统计中扣除，这里只计释放次数
+    mem_free(data,0,MEM_PRINT);
+    return ok;
+}
+
+// 检查快照头部，返回根结点；只检查头部，不遍历结点。字符串表不为空时最后一个字节必须是'\0'，
+// 这样落在表中的任何位置开始的字符串都在快照内结束
+const cJSON_SnapNode* cJSON_SnapshotRoot(const void* data,size_t len){
+    const snapshot_header* h = (const snapshot_header*)data;
+    const struct cJSON_SnapNode* root = (const struct cJSON_SnapNode*)(h + 1);
+    if (!data || len < sizeof(snapshot_header) + sizeof(struct cJSON_SnapNode) || memcmp(h->magic,SNAPSHOT_MAGIC,8) ||
+        h->version != SNAPSHOT_VERSION || h->byteorder != 0x01020304 || h->size != len || !h->nodes ||
+        h->nodes > (len - sizeof(snapshot_header)) / sizeof(struct cJSON_SnapNode) || root->index != 0 ||
+        (len > sizeof(snapshot_header) + h->nodes * sizeof(struct cJSON_SnapNode) && ((const char*)data)[len - 1]))
+    {
+        return 0;
+    }
+    return root;
+}
+
+const cJSON_SnapNode* cJSON_LoadSnapshot(const char* path){
+    const cJSON_SnapNode* root;
+#ifndef _WIN32
+    int fd;
+    struct stat st;
+    void* map;
+    fd = open(path,O_RDONLY);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    if (fstat(fd,&st) < 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return 0;
+    }
+    // 只读共享映射：多个进程加载同一个快照时共用页缓存，只有被访问到的页才会读入
+    map = mmap(0,(size_t)st.st_size,PROT_READ,MAP_SHARED,fd,0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return 0;
+    }
+    root = cJSON_SnapshotRoot(map,(size_t)st.st_size);
+    if (!root)
+    {
+        munmap(map,(size_t)st.st_size);
+    }
+    return root;
+#else
+    size_t len = 0,maplen = 0;
+    char* data = map_file(path,&len,&maplen);
+    if (!data)
+    {
+        return 0;
+    }
+    root = cJSON_SnapshotRoot(data,len);
+    if (!root)
+    {
+        unmap_file(data,maplen);
+    }
+    return root;
+#endif
+}
+
+// 释放cJSON_LoadSnapshot建立的映射，根结点前面就是文件头，里面记录了映射的长度
+void cJSON_CloseSnapshot(const cJSON_SnapNode* root){
+    const snapshot_header* h;
+    if (!root)
+    {
+        return;
+    }
+    h = (const snapshot_header*)root - 1;
+#ifndef _WIN32
+    munmap((void*)h,(size_t)h->size);
+#else
+    // map_file多读了一个结尾的'\0'
+    unmap_file((char*)h,(size_t)h->size + 1);
+#endif
+}
+
+// 访问时的范围检查。API交出的结点都检查过下标，所以由下标找到的文件头是对的；每次访问只比较几次，不遍历快照
+
+// 由结点记录的下标找到快照头部
+static const snapshot_header* snapshot_head(const struct cJSON_SnapNode* n){
+    return (const snapshot_header*)(n - n->index) - 1;
+}
+
+// 相对于结点n的偏移off处的字符串，必须从字符串表中开始，否则返回0
+static const char* snapshot_string(const struct cJSON_SnapNode* n,long long off){
+    const snapshot_header* h = snapshot_head(n);
+    long long self = (long long)sizeof(snapshot_header) + (long long)(n->index * sizeof(struct cJSON_SnapNode));
+    long long table = (long long)sizeof(snapshot_header) + (long long)(h->nodes * sizeof(struct cJSON_SnapNode));
+    if (off < table - self || off >= (long long)h->size - self)
+    {
+        return 0;
+    }
+    return (const char*)n + off;
+}
+
+// 容器n的第一个子结点：count个子结点必须整个落在结点数组中
+static const struct cJSON_SnapNode* snapshot_children(const struct cJSON_SnapNode* n){
+    const snapshot_header* h = snapshot_head(n);
+    long long off = n->value.offset;
+    if (off % (long long)sizeof(struct cJSON_SnapNode))
+    {
+        return 0;
+    }
+    // 以结点为单位，子结点占[index + off, index + off + count)
+    off /= (long long)sizeof(struct cJSON_SnapNode);
+    if (off < -(long long)n->index || off > (long long)(h->nodes - n->index) - (long long)n->count)
+    {
+        return 0;
+    }
+    return n + off;
+}
+
+// 交出一个结点之前检查它记录的下标就是它在结点数组中的位置，head是0号结点
+static int snapshot_placed(const struct cJSON_SnapNode* c,const struct cJSON_SnapNode* head){
+    return c->index == (unsigned long long)(c - head);
+}
+
+int cJSON_SnapshotType(const cJSON_SnapNode* node){
+    return node ? node->type : cJSON_NULL;
+}
+
+const char* cJSON_SnapshotKey(const cJSON_SnapNode* node){
+    return (node && node->key) ? snapshot_string(node,node->key) : 0;
+}
+
+const char* cJSON_SnapshotString(const cJSON_SnapNode* node){
+    return (node && node->type == cJSON_String) ? snapshot_string(node,node->value.offset) : 0;
+}
+
+double cJSON_SnapshotNumber(const cJSON_SnapNode* node){
+    return (node && node->type == cJSON_Number) ? node->value.number : 0;
+}
+
+int cJSON_SnapshotGetArraySize(const cJSON_SnapNode* array){
+    return (array && (array->type == cJSON_Array || array->type == cJSON_Object)) ? (int)array->count : 0;
+}
+
+// 子结点连续存放，直接按下标计算位置
+const cJSON_SnapNode* cJSON_SnapshotGetArrayItem(const cJSON_SnapNode* array,int item){
+    const cJSON_SnapNode* c;
+    if (item < 0 || item >= cJSON_SnapshotGetArraySize(array) || !(c = snapshot_children(array)))
+    {
+        return 0;
+    }
+    c += item;
+    return snapshot_placed(c,array - array->index) ? c : 0;
+}
+
+// 和cJSON_GetObjectItem一样，按键查找时不区分大小写
+const cJSON_SnapNode* cJSON_SnapshotGetObjectItem(const cJSON_SnapNode* object,const char* string){
+    const cJSON_SnapNode* c;
+    const char* key;
+    unsigned int i;
+    if (!object || object->type != cJSON_Object || !(c = snapshot_children(object)))
+    {
+        return 0;
+    }
+    for (i = 0;i < object->count;i++,c++)
+    {
+        if (!snapshot_placed(c,object - object->index))
+        {
+            return 0;
+        }
+        key = cJSON_SnapshotKey(c);
+        if (key && !cJSON_strcasecmp(key,string))
+        {
+            return c;
+        }
+    }
+    return 0;
+}
+
+// 结构体绑定：按照字段表直接在文本和结构体之间转换，不建立cJSON树
+
+// 跳过以引号开头的字符串，返回结尾引号之后的位置，没有结尾引号时返回0
+static const char* skip_string(const char* ptr){
+    ptr++;
+    // strcspn在C库中是按块比较的，跳过长字符串比逐字节判断快得多
+    for (;;)
+    {
+        ptr += strcspn(ptr,"\"\\");
+        if (*ptr == '\"')
+        {
+            return ptr + 1;
+        }
+        if (!*ptr || !ptr[1])
+        {
+            return 0;
+        }
+        ptr += 2;
+    }
+}
+
+// 跳过一个完整的值，不递归也不申请内存；格式错误时返回0并设置ep
+// 和cJSON_Validate一样用栈上的位图记下每层是数组还是对象，检查括号的种类以及逗号、冒号的位置，
+// 嵌套层数的上限同cJSON_Validate；字符串只找结尾的引号，数字只检查字符的范围，需要时由调用者解析
+static const char* skip_value(const char* value){
+    // 每层一位：1是对象，0是数组
+    unsigned char kinds[VALIDATE_DEPTH / 8];
+    size_t limit = nesting_limit < VALIDATE_DEPTH ? nesting_limit : VALIDATE_DEPTH;
+    size_t depth = 0;
+    const char* start;
+    int object = 0;
+    for (;;)
+    {
+        // 开始一个值
+        value = skip(value);
+        start = value;
+        if (*value == '{' || *value == '[')
+        {
+            object = (*value == '{');
+            value = skip(value + 1);
+            if (*value != (object ? '}' : ']'))
+            {
+                if (depth >= limit)
+                {
+                    ep = start;
+                    return 0;
+                }
+                if (object)
+                {
+                    kinds[depth / 8] |= (unsigned char)(1 << (depth % 8));
+                }else{
+                    kinds[depth / 8] &= (unsigned char)~(1 << (depth % 8));
+                }
+                depth++;
+                if (object)
+                {
+                    goto key;
+                }
+                continue;
+            }
+            value++;
+        }else if (*value == '\"')
+        {
+            value = skip_string(value);
+        }else if (*value == 't' || *value == 'n')
+        {
+            value = strncmp(value,*value == 't' ? "true" : "null",4) ? 0 : value + 4;
+        }else if (*value == 'f')
+        {
+            value = strncmp(value,"false",5) ? 0 : value + 5;
+        }else{
+            // 数字：可选的负号之后至少有一位数字
+            if (*value == '-')
+            {
+                value++;
+            }
+            if (*value < '0' || *value > '9')
+            {
+                value = 0;
+            }else{
+                while ((*value >= '0' && *value <= '9') || *value == '.' || *value == 'e' || *value == 'E' || *value == '+' || *value == '-')
+                {
+                    value++;
+                }
+            }
+        }
+        if (!value)
+        {
+            ep = start;
+            return 0;
+        }
+        // 一个值结束，处理所在容器后面的逗号或者结束符
+        for (;;)
+        {
+            value = skip(value);
+            if (!depth)
+            {
+                return value;
+            }
+            object = (kinds[(depth - 1) / 8] >> ((depth - 1) % 8)) & 1;
+            if (*value == (object ? '}' : ']'))
+            {
+                value++;
+                depth--;
+                continue;
+            }
+            if (*value != ',')
+            {
+                ep = value;
+                return 0;
+            }
+            value++;
+            break;
+        }
+        if (!object)
+        {
+            continue;
+        }
+    key:
+        // 对象的成员先跳过键和冒号
+        value = skip(value);
+        start = value;
+        if (*value != '\"' || !(value = skip_string(value)))
+        {
+            ep = start;
+            return 0;
+        }
+        value = skip(value);
+        if (*value != ':')
+        {
+            ep = value;
+            return 0;
+        }
+        value++;
+    }
+}
+
+// 不区分大小写地比较以'\0'结尾的name和长度为len的key
+static int key_equal(const char* name,const char* key,size_t len){
+    size_t i;
+    for (i = 0;i < len;i++)
+    {
+        if (!name[i] || tolower((unsigned char)name[i]) != tolower((unsigned char)key[i]))
+        {
+            return 0;
+        }
+    }
+    return !name[len];
+}
+
+// 查找key（开头的引号之后，长度为len，未解码）对应的字段；字段通常按顺序出现，从上一个匹配的字段之后开始找
+static const cJSON_Field* find_field(const cJSON_Binding* b,const char* key,size_t len,int* hint){
+    char local[256];
+    char* decoded = 0;
+    char* end;
+    const cJSON_Field* found = 0;
+    size_t size = 0;
+    int i;
+    int n;
+    // 带转义字符的键先解码，一般的键很短，用栈上的缓冲区
+    if (memchr(key,'\\',len))
+    {
+        size = string_length(key) + 1;
+        decoded = size <= sizeof(local) ? local : (char*)mem_alloc(size,MEM_OTHER);
+        if (!decoded)
+        {
+            return 0;
+        }
+        decode_string(key,decoded,&end);
+        key = decoded;
+        len = end - decoded;
+    }
+    for (i = 0;i < b->count && !found;i++)
+    {
+        n = (*hint + i) % b->count;
+        if (key_equal(b->fields[n].name,key,len))
+        {
+            found = b->fields + n;
+            *hint = n + 1;
+        }
+    }
+    // 按申请时的大小释放，解码后的字符串可能更短
+    if (decoded && decoded != local)
+    {
+        mem_free(decoded,size,MEM_OTHER);
+    }
+    return found;
+}
+
+static const char* parse_struct(const cJSON_Binding* b,char* out,const char* value);
+
+// 把一个值写入字段，类型不符时出错
+static const char* parse_field(const cJSON_Field* f,char* dst,const char* value){
+    cJSON num;
+    char* str;
+    char* end;
+    int len;
+    if (!strncmp(value,"null",4))
+    {
+        if (f->type == cJSON_FieldString)
+        {
+            *(char**)dst = 0;
+        }
+        return value + 4;
+    }
+    switch (f->type)
+    {
+    case cJSON_FieldInt:
+    case cJSON_FieldDouble:
+        if (*value != '-' && (*value < '0' || *value > '9'))
+        {
+            break;
+        }
+        value = parse_number(&num,value);
+        if (f->type == cJSON_FieldDouble)
+        {
+            *(double*)dst = num.valuedouble;
+        }else{
+            node_set_number(&num,num.valuedouble);
+            *(int*)dst = num.valuedoint;
+        }
+        return value;
+    case cJSON_FieldBool:
+        if (!strncmp(value,"true",4))
+        {
+            *(int*)dst = 1;
+            return value + 4;
+        }
+        if (!strncmp(value,"false",5))
+        {
+            *(int*)dst = 0;
+            return value + 5;
+        }
+        break;
+    case cJSON_FieldString:
+    case cJSON_FieldChars:
+        if (*value != '\"' || !skip_string(value))
+        {
+            break;
+        }
+        len = string_length(value + 1);
+        if (f->type == cJSON_FieldChars && (size_t)len < f->size)
+        {
+            // 解码前的长度就放得下，直接解码到数组中
+            return decode_string(value + 1,dst,&end);
+        }
+        str = (char*)mem_alloc(len + 1,MEM_STRING);
+        if (!str)
+        {
+            return 0;
+        }
+        value = decode_string(value + 1,str,&end);
+        mem_account(MEM_STRING,len + 1,end - str + 1);
+        if (f->type == cJSON_FieldString)
+        {
+            *(char**)dst = str;
+            return value;
+        }
+        // 转义序列解码后变短，可能还是放得下
+        len = (int)(end - str);
+        if ((size_t)len < f->size)
+        {
+            memcpy(dst,str,len + 1);
+        }else{
+            value = 0;
+        }
+        mem_free(str,len + 1,MEM_STRING);
+        return value;
+    case cJSON_FieldStruct:
+        return parse_struct(f->binding,dst,value);
+    default:
+        break;
+    }
+    ep = value;
+    return 0;
+}
+
+// 按字段表解析一个对象，写入out指向的结构体
+static const char* parse_struct(const cJSON_Binding* b,char* out,const char* value){
+    // 本次解析中已经写入的字符串字段，每个字段一位：同一个键再次出现时以后面的值为准，先释放前一次申请的字符串
+    unsigned char local[32];
+    unsigned char* seen = local;
+    size_t seensize = ((size_t)b->count + 7) / 8;
+    const cJSON_Field* f;
+    const char* key;
+    char** str;
+    int hint = 0;
+    int i;
+    value = skip(value);
+    if (*value != '{')
+    {
+        ep = value;
+        return 0;
+    }
+    value = skip(value + 1);
+    if (*value == '}')
+    {
+        return value + 1;
+    }
+    if (seensize > sizeof(local))
+    {
+        seen = (unsigned char*)mem_alloc(seensize,MEM_OTHER);
+        if (!seen)
+        {
+            return 0;
+        }
+    }
+    memset(seen,0,seensize);
+    for (;;)
+    {
+        key = value;
+        if (*value != '\"' || !(value = skip_string(value)))
+        {
+            ep = key;
+            value = 0;
+            break;
+        }
+        f = find_field(b,key + 1,value - key - 2,&hint);
+        value = skip(value);
+        if (*value != ':')
+        {
+            ep = value;
+            value = 0;
+            break;
+        }
+        value = skip(value + 1);
+        if (f && f->type == cJSON_FieldString)
+        {
+            i = (int)(f - b->fields);
+            str = (char**)(out + f->offset);
+            if ((seen[i / 8] >> (i % 8)) & 1 && *str)
+            {
+                mem_free(*str,mem_strsize(*str),MEM_STRING);
+                *str = 0;
+            }
+            seen[i / 8] |= (unsigned char)(1 << (i % 8));
+        }
+        value = f ? parse_field(f,out + f->offset,value) : skip_value(value);
+        if (!value)
+        {
+            if (f && !ep)
+            {
+                ep = key;
+            }
+            break;
+        }
+        value = skip(value);
+        if (*value == '}')
+        {
+            value++;
+            break;
+        }
+        if (*value != ',')
+        {
+            ep = value;
+            value = 0;
+            break;
+        }
+        value = skip(value + 1);
+    }
+    if (seen != local)
+    {
+        mem_free(seen,seensize,MEM_OTHER);
+    }
+    return value;
+}
+
+int cJSON_ParseStruct(const char* value,const cJSON_Binding* binding,void* out){
+    ep = 0;
+    if (!value || !binding || !out)
+    {
+        return 0;
+    }
+    return parse_struct(binding,(char*)out,value) ? 1 : 0;
+}
+
+int cJSON_ParseStructArray(const char* value,const cJSON_Binding* binding,void* out,int capacity){
+    int count = 0;
+    ep = 0;
+    if (!value || !binding || (!out && capacity))
+    {
+        return -1;
+    }
+    value = skip(value);
+    if (*value != '[')
+    {
+        ep = value;
+        return -1;
+    }
+    value = skip(value + 1);
+    if (*value == ']')
+    {
+        return 0;
+    }
+    for (;;)
+    {
+        if (count >= capacity)
+        {
+            ep = value;
+            return -1;
+        }
+        value = parse_struct(binding,(char*)out + count * binding->size,value);
+        if (!value)
+        {
+            return -1;
+        }
+        count++;
+        value = skip(value);
+        if (*value == ']')
+        {
+            return count;
+        }
+        if (*value != ',')
+        {
+            ep = value;
+            return -1;
+        }
+        value = skip(value + 1);
+    }
+}
+
+void cJSON_FreeStruct(const cJSON_Binding* binding,void* s){
+    const cJSON_Field* f;
+    char** str;
+    int i;
+    if (!binding || !s)
+    {
+        return;
+    }
+    for (i = 0;i < binding->count;i++)
+    {
+        f = binding->fields + i;
+        if (f->type == cJSON_FieldString)
+        {
+            str = (char**)((char*)s + f->offset);
+            if (*str)
+            {
+                mem_free(*str,mem_strsize(*str),MEM_STRING);
+                *str = 0;
+            }
+        }else if (f->type == cJSON_FieldStruct)
+        {
+            cJSON_FreeStruct(f->binding,(char*)s + f->offset);
+        }
+    }
+}
+
+// 把字符串或者字面量追加到缓冲区末尾
+static int print_append(printbuffer* p,const char* str){
+    size_t len = strlen(str);
+    char* ptr = ensure(p,len + 1);
+    if (!ptr)
+    {
+        return 0;
+    }
+    memcpy(ptr,str,len + 1);
+    p->offset += len;
+    return 1;
+}
+
+static int print_struct(const cJSON_Binding* b,const char* s,int depth,int fmt,printbuffer* p);
+
+// 打印一个字段的值，格式和打印对应的cJSON结点相同
+static int print_field(const cJSON_Field* f,const char* src,int depth,int fmt,printbuffer* p){
+    cJSON num;
+    const char* str;
+    switch (f->type)
+    {
+    case cJSON_FieldInt:
+    case cJSON_FieldDouble:
+        memset(&num,0,sizeof(num));
+        node_set_number(&num,f->type == cJSON_FieldInt ? (double)*(const int*)src : *(const double*)src);
+        if (!print_number(&num,p))
+        {
+            return 0;
+        }
+        break;
+    case cJSON_FieldBool:
+        return print_append(p,*(const int*)src ? "true" : "false");
+    case cJSON_FieldString:
+        str = *(char* const*)src;
+        if (!str)
+        {
+            return print_append(p,"null");
+        }
+        if (!print_string_ptr(str,p))
+        {
+            return 0;
+        }
+        break;
+    case cJSON_FieldChars:
+        if (!print_string_ptr(src,p))
+        {
+            return 0;
+        }
+        break;
+    case cJSON_FieldStruct:
+        return print_struct(f->binding,src,depth,fmt,p);
+    default:
+        return print_append(p,"null");
+    }
+    p->offset = update(p);
+    return 1;
+}
+
+// 和print_object使用缓冲区时的格式一致
+static int print_struct(const cJSON_Binding* b,const char* s,int depth,int fmt,printbuffer* p){
+    char* ptr;
+    int i;
+    int j;
+    if (!b->count)
+    {
+        ptr = ensure(p,fmt ? depth + 4 : 3);
+        if (!ptr)
+        {
+            return 0;
+        }
+        *ptr++ = '{';
+        if (fmt)
+        {
+            *ptr++ = '\n';
+            for (j = 0;j < depth;j++)
+            {
+                *ptr++ = '\t';
+            }
+        }
+        *ptr++ = '}';
+        *ptr = 0;
+        p->offset = update(p);
+        return 1;
+    }
+    if (!print_append(p,fmt ? "{\n" : "{"))
+    {
+        return 0;
+    }
+    depth++;
+    for (i = 0;i < b->count;i++)
+    {
+        if (fmt)
+        {
+            ptr = ensure(p,depth + 1);
+            if (!ptr)
+            {
+                return 0;
+            }
+            for (j = 0;j < depth;j++)
+            {
+                *ptr++ = '\t';
+            }
+            *ptr = 0;
+            p->offset += depth;
+        }
+        if (!print_string_ptr(b->fields[i].name,p))
+        {
+            return 0;
+        }
+        p->offset = update(p);
+        if (!print_append(p,fmt ? ":\t" : ":") || !print_field(b->fields + i,s + b->fields[i].offset,depth,fmt,p))
+        {
+            return 0;
+        }
+        if (i != b->count - 1 && !print_append(p,","))
+        {
+            return 0;
+        }
+        if (fmt && !print_append(p,"\n"))
+        {
+            return 0;
+        }
+    }
+    ptr = ensure(p,depth + 1);
+    if (!ptr)
+    {
+        return 0;
+    }
+    if (fmt)
+    {
+        for (j = 0;j < depth - 1;j++)
+        {
+            *ptr++ = '\t';
+        }
+    }
+    *ptr++ = '}';
+    *ptr = 0;
+    p->offset = update(p);
+    return 1;
+}
+
+// array不为0时打印count个结构体组成的数组
+static char* print_struct_root(const cJSON_Binding* binding,const void* s,int count,int array,int fmt){
+    printbuffer p;
+    int ok = 1;
+    int i;
+    if (!binding || (!s && (count || !array)))
+    {
+        return 0;
+    }
+    p.length = 256;
+    p.offset = 0;
+    p.buffer = (char*)mem_alloc(p.length,MEM_PRINT);
+    if (!p.buffer)
+    {
+        return 0;
+    }
+    if (!array)
+    {
+        ok = print_struct(binding,(const char*)s,0,fmt,&p);
+    }else{
+        // 和print_array使用缓冲区时的格式一致
+        ok = print_append(&p,"[");
+        for (i = 0;i < count && ok;i++)
+        {
+            ok = print_struct(binding,(const char*)s + i * binding->size,1,fmt,&p) &&
+                 (i == count - 1 || print_append(&p,fmt ? ", " : ","));
+        }
+        ok = ok && print_append(&p,"]");
+    }
+    if (!ok)
+    {
+        mem_free(p.buffer,p.length,MEM_PRINT);
+        return 0;
+    }
+    mem_account(MEM_PRINT,p.length,0);
+    return p.buffer;
+}
+
+char* cJSON_PrintStruct(const cJSON_Binding* binding,const void* s,int fmt){
+    return print_struct_root(binding,s,0,0,fmt);
+}
+
+char* cJSON_PrintStructArray(const cJSON_Binding* binding,const void* s,int count,int fmt){
+    return print_struct_root(binding,s,count,1,fmt);
+}
+
+// 词法层接口：结构体绑定用到的扫描和格式化函数，供自己遍历文本的生成代码（cjson_reflect.hpp）使用
+
+void cJSON_SetErrorPtr(const char* at){
+    ep = at;
+}
+
+const char* cJSON_SkipValue(const char* value){
+    if (!value)
+    {
+        return 0;
+    }
+    return skip_value(value);
+}
+
+const char* cJSON_ParseNumberToken(const char* value,double* number){
+    cJSON num;
+    if (!value || (*value != '-' && (*value < '0' || *value > '9')))
+    {
+        ep = value;
+        return 0;
+    }
+    value = parse_number(&num,value);
+    *number = num.valuedouble;
+    return value;
+}
+
+int cJSON_StringTokenLength(const char* value){
+    if (!value || *value != '\"' || !skip_string(value))
+    {
+        ep = value;
+        return -1;
+    }
+    return string_length(value + 1);
+}
+
+const char* cJSON_DecodeStringToken(const char* value,char* out,size_t* len){
+    char* end;
+    value = decode_string(value + 1,out,&end);
+    if (len)
+    {
+        *len = end - out;
+    }
+    return value;
+}
+
+size_t cJSON_PrintNumberToken(double number,char* out){
+    cJSON num;
+    printbuffer p;
+    memset(&num,0,sizeof(num));
+    node_set_number(&num,number);
+    p.buffer = out;
+    p.length = 64;
+    p.offset = 0;
+    print_number(&num,&p);
+    return strlen(out);
+}
+
+size_t cJSON_PrintStringToken(const char* str,char* out,size_t size){
+    printbuffer p;
+    size_t len = (str ? escaped_length(str,strlen(str)) : 0) + 2;
+    // 放得下时才写，缓冲区不是申请来的，不能交给ensure扩大
+    if (out && size > len)
+    {
+        p.buffer = out;
+        p.length = size;
+        p.offset = 0;
+        print_string_ptr(str,&p);
+    }
+    return len;
+}
+
+/* 压缩：不建树，直接去掉字符串以外的空白 */
+
+// 64个字节的位图：空白（和skip一致，ASCII码<=32的字节）、引号和反斜杠，第i位对应第i个字节
+static void minify_classify(const char* in,unsigned long long* space,unsigned long long* quote,unsigned long long* backslash){
+    int i;
+#ifdef CJSON_SSE2
+    __m128i blank = _mm_set1_epi8(32);
+    __m128i q = _mm_set1_epi8('"');
+    __m128i b = _mm_set1_epi8('\\');
+    __m128i v;
+    *space = *quote = *backslash = 0;
+    for (i = 0;i < 64;i += 16)
+    {
+        v = _mm_loadu_si128((const __m128i*)(in + i));
+        // 无符号比较：c <= 32 等价于 max(c,32) == 32
+        *space |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v,blank),blank)) << i;
+        *quote |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v,q)) << i;
+        *backslash |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v,b)) << i;
+    }
+#else
+    *space = *quote = *backslash = 0;
+    for (i = 0;i < 64;i++)
+    {
+        *space |= (unsigned long long)((unsigned char)in[i] <= 32) << i;
+        *quote |= (unsigned long long)(in[i] == '"') << i;
+        *backslash |= (unsigned long long)(in[i] == '\\') << i;
+    }
+#endif
+}
+
+// 被反斜杠转义的字节的位图，不用分支（simdjson的做法）：一串连续的反斜杠两两配对，奇数个时最后一个转义下一个字节。
+// 给每串反斜杠的开头减去1，借位一直传到这串的末尾，再和奇数位比较就知道每个反斜杠是不是转义符；
+// *carry为1时这一块的第一个字节被上一块末尾的反斜杠转义，返回前换成这一块末尾的情况
+static unsigned long long minify_escaped(unsigned long long backslash,unsigned long long* carry){
+    const unsigned long long odd = 0xAAAAAAAAAAAAAAAAULL;
+    unsigned long long potential = backslash & ~*carry;
+    unsigned long long code = (((potential << 1) | odd) - potential) ^ odd;
+    unsigned long long escaped = code ^ (backslash | *carry);
+    *carry = (code & backslash) >> 63;
+    return escaped;
+}
+
+// 前缀异或：第i位是x的第0到i位的异或，引号的位图变成字符串内部的位图（包括开头的引号）
+static unsigned long long prefix_xor(unsigned long long x){
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// 把in开始的len个字节压缩到out，返回写入的长度。out可以等于in，也可以是另一块len个字节的缓冲区。
+// 反斜杠总是保留下一个字节，被转义的引号不开始也不结束字符串，字符串内部原样复制，其他地方去掉空白。
+// 每次处理64个字节：先复制到block，再按段写回；段尾整块写16个字节，只在不超过这64个字节的位置时进行，
+// 原地压缩时写入的位置不超过已经读过的位置，所以不会改掉还没读的内容
+static size_t minify(const char* in,size_t len,char* out){
+    const char* begin = in;
+    const char* end = in + len;
+    char* start = out;
+    char block[64 + 16];
+    unsigned long long space;
+    unsigned long long quote;
+    unsigned long long backslash;
+    unsigned long long keep;
+    unsigned long long escaped;
+    unsigned long long carry = 0;
+    unsigned long long inside = 0;
+    int i;
+    int run;
+    memset(block,0,sizeof(block));
+    while (end - in >= 64)
+    {
+        minify_classify(in,&space,&quote,&backslash);
+        escaped = backslash ? minify_escaped(backslash,&carry) : carry;
+        if (!backslash)
+        {
+            carry = 0;
+        }
+        // inside的每一位都是上一块末尾是否在字符串中，和这一块的前缀异或合起来
+        quote = prefix_xor(quote & ~escaped) ^ inside;
+        inside = 0 - (quote >> 63);
+        keep = ~(space & ~quote) | escaped;
+        if (!~keep)
+        {
+            memmove(out,in,64);
+            out += 64;
+            in += 64;
+            continue;
+        }
+        memcpy(block,in,64);
+        while (keep)
+        {
+            i = lowest_bit(keep);
+            // 从i开始连续的1的个数；keep不会全是1，~(keep >> i)总有为1的位
+            run = lowest_bit(~(keep >> i));
+            // 加上最低的1，进位清掉这一段
+            keep &= keep + (keep & (0 - keep));
+            while (run > 16)
+            {
+                memcpy(out,block + i,16);
+                out += 16;
+                i += 16;
+                run -= 16;
+            }
+            if ((size_t)(out - start) + 16 <= (size_t)(in - begin) + 64)
+            {
+                memcpy(out,block + i,16);
+            }else{
+                memcpy(out,block + i,run);
+            }
+            out += run;
+        }
+        in += 64;
+    }
+    // 不足64个字节的部分逐个字节处理，状态接着上面
+    for (;in < end;in++)
+    {
+        if (carry)
+        {
+            carry = 0;
+        }else if (*in == '\\')
+        {
+            carry = 1;
+        }else if (*in == '"')
+        {
+            inside = ~inside;
+        }else if ((unsigned char)*in <= 32 && !inside)
+        {
+            continue;
+        }
+        *out++ = *in;
+    }
+    return out - start;
+}
+
+size_t cJSON_Minify(char* json){
+    size_t len;
+    if (!json)
+    {
+        return 0;
+    }
+    len = minify(json,strlen(json),json);
+    json[len] = 0;
+    return len;
+}
+
+size_t cJSON_MinifyBuffer(const char* json,size_t len,char* out){
+    if (!json || !out)
+    {
+        return 0;
+    }
+    len = minify(json,len,out);
+    out[len] = 0;
+    return len;
+}
+
+/* 只检查语法：不申请内存、不递归的校验 */
+
+// 校验p处的数字：-?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?，返回数字之后的位置；出错时ep指向出错的字节，返回0
+static const unsigned char* validate_number(const unsigned char* p,const unsigned char* end){
+    if (p < end && *p == '-')
+    {
+        p++;
+    }
+    if (p < end && *p == '0')
+    {
+        p++;
+    }else if (p < end && *p >= '1' && *p <= '9')
+    {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+    }else{
+        ep = (const char*)p;
+        return 0;
+    }
+    if (p < end && *p == '.')
+    {
+        p++;
+        if (p == end || *p < '0' || *p > '9')
+        {
+            ep = (const char*)p;
+            return 0;
+        }
+        p++;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        if (p < end && (*p == '+' || *p == '-'))
+        {
+            p++;
+        }
+        if (p == end || *p < '0' || *p > '9')
+        {
+            ep = (const char*)p;
+            return 0;
+        }
+        p++;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+    }
+    return p;
+}
+
+// 跳过RFC 8259中的空白：空格、制表符、换行和回车
+static const unsigned char* validate_skip(const unsigned char* p,const unsigned char* end){
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+    {
+        p++;
+    }
+    return p;
+}
+
+int cJSON_Validate(const char* json,size_t len,size_t* error){
+    // 每层一位：1是对象，0是数组
+    unsigned char kinds[VALIDATE_DEPTH / 8];
+    const unsigned char* p = (const unsigned char*)json;
+    const unsigned char* end = p + len;
+    const unsigned char* start;
+    size_t limit = nesting_limit < VALIDATE_DEPTH ? nesting_limit : VALIDATE_DEPTH;
+    size_t depth = 0;
+    int object;
+    if (!json)
+    {
+        ep = 0;
+        if (error)
+        {
+            *error = 0;
+        }
+        return 0;
+    }
+    for (;;)
+    {
+        // 开始一个值
+        p = validate_skip(p,end);
+        if (p == end)
+        {
+            ep = (const char*)p;
+            goto fail;
+        }
+        switch (*p)
+        {
+        case '{':
+        case '[':
+            start = p;
+            object = *p == '{';
+            p = validate_skip(p + 1,end);
+            if (p < end && *p == (object ? '}' : ']'))
+            {
+                p++;
+                break;
+            }
+            if (depth >= limit)
+            {
+                ep = (const char*)start;
+                goto fail;
+            }
+            if (object)
+            {
+                kinds[depth / 8] |= (unsigned char)(1 << (depth % 8));
+            }else{
+                kinds[depth / 8] &= (unsigned char)~(1 << (depth % 8));
+            }
+            depth++;
+            // 对象的成员先校验键和冒号
+            if (object)
+            {
+                goto key;
+            }
+            continue;
+        case '"':
+            p = validate_string(p,end,1);
+            if (!p)
+            {
+                goto fail;
+            }
+            break;
+        case 't':
+            if (end - p < 4 || memcmp(p,"true",4))
+            {
+                ep = (const char*)p;
+                goto fail;
+            }
+            p += 4;
+            break;
+        case 'f':
+            if (end - p < 5 || memcmp(p,"false",5))
+            {
+                ep = (const char*)p;
+                goto fail;
+            }
+            p += 5;
+            break;
+        case 'n':
+            if (end - p < 4 || memcmp(p,"null",4))
+            {
+                ep = (const char*)p;
+                goto fail;
+            }
+            p += 4;
+            break;
+        default:
+            p = validate_number(p,end);
+            if (!p)
+            {
+                goto fail;
+            }
+            break;
+        }
+        // 一个值结束，处理所在容器后面的逗号或者结束符
+        for (;;)
+        {
+            p = validate_skip(p,end);
+            if (!depth)
+            {
+                if (p != end)
+                {
+                    ep = (const char*)p;
+                    goto fail;
+                }
+                if (error)
+                {
+                    *error = len;
+                }
+                return 1;
+            }
+            object = (kinds[(depth - 1) / 8] >> ((depth - 1) % 8)) & 1;
+            if (p < end && *p == (object ? '}' : ']'))
+            {
+                p++;
+                depth--;
+                continue;
+            }
+            if (p == end || *p != ',')
+            {
+                ep = (const char*)p;
+                goto fail;
+            }
+            p++;
+            break;
+        }
+        if (!object)
+        {
+            continue;
+        }
+key:
+        p = validate_skip(p,end);
+        if (p == end || *p != '"')
+        {
+            ep = (const char*)p;
+            goto fail;
+        }
+        p = validate_string(p,end,1);
+        if (!p)
+        {
+            goto fail;
+        }
+        p = validate_skip(p,end);
+        if (p == end || *p != ':')
+        {
+            ep = (const char*)p;
+            goto fail;
+        }
+        p++;
+    }
+fail:
+    if (error)
+    {
+        *error = (const unsigned char*)ep - (const unsigned char*)json;
+    }
+    return 0;
+}
+
+/* 规范化打印：RFC 8785(JCS)，用于计算哈希和缓存键 */
+
+// 按ECMAScript的Number.prototype.toString打印有限的d（RFC 8785第3.2.2.3节），返回写入的字节数，buf至少要32个字节
+static int canonical_number(double d,char* buf){
+    char sci[32],digits[20];
+    int len = 0,k = 0,n,prec,i;
+    unsigned long long v;
+    const char* ptr;
+    // -0也打印成0
+    if (d == 0)
+    {
+        strcpy(buf,"0");
+        return 1;
+    }
+    if (d < 0)
+    {
+        buf[len++] = '-';
+        d = -d;
+    }
+    // 小于2^53的整数是最常见的情况，直接逐位转换
+    if (d < 9007199254740992.0 && d == floor(d))
+    {
+        v = (unsigned long long)d;
+        do
+        {
+            digits[k++] = (char)('0' + v % 10);
+            v /= 10;
+        } while (v);
+        while (k)
+        {
+            buf[len++] = digits[--k];
+        }
+        buf[len] = 0;
+        return len;
+    }
+    // 能还原出d的最短的有效数字：15位以内的十进制数都能被double区分，所以15位能还原时去掉末尾的0就是最短的；
+    // 否则依次试16位和17位，17位总能还原。sprintf按正确舍入取最接近d的那一个，和ECMAScript的要求一致
+    // 非规格化数的精度不到15位，要从1位开始试
+    for (prec = (d < DBL_MIN) ? 0 : 14;prec < 16;prec++)
+    {
+        sprintf(sci,"%.*e",prec,d);
+        if (strtod(sci,0) == d)
+        {
+            break;
+        }
+    }
+    if (prec == 16)
+    {
+        sprintf(sci,"%.16e",d);
+    }
+    // sci形如"d.ddde+XX"，取出有效数字，n是小数点相对于第一位数字的位置
+    for (ptr = sci;*ptr != 'e';ptr++)
+    {
+        if (*ptr >= '0' && *ptr <= '9')
+        {
+            digits[k++] = *ptr;
+        }
+    }
+    n = atoi(ptr + 1) + 1;
+    while (k > 1 && digits[k - 1] == '0')
+    {
+        k--;
+    }
+    if (k <= n && n <= 21)
+    {
+        // 整数：数字后面补0
+        memcpy(buf + len,digits,k);
+        len += k;
+        for (i = k;i < n;i++)
+        {
+            buf[len++] = '0';
+        }
+    }else if (n > 0 && n <= 21)
+    {
+        // 小数点在数字中间
+        memcpy(buf + len,digits,n);
+        len += n;
+        buf[len++] = '.';
+        memcpy(buf + len,digits + n,k - n);
+        len += k - n;
+    }else if (n > -6 && n <= 0)
+    {
+        // 0.000ddd
+        buf[len++] = '0';
+        buf[len++] = '.';
+        for (i = n;i < 0;i++)
+        {
+            buf[len++] = '0';
+        }
+        memcpy(buf + len,digits,k);
+        len += k;
+    }else{
+        // 科学计数法：d.ddde+XX，指数不补0
+        buf[len++] = digits[0];
+        if (k > 1)
+        {
+            buf[len++] = '.';
+            memcpy(buf + len,digits + 1,k - 1);
+            len += k - 1;
+        }
+        len += sprintf(buf + len,"e%c%d",n - 1 >= 0 ? '+' : '-',n - 1 >= 0 ? n - 1 : 1 - n);
+    }
+    buf[len] = 0;
+    return len;
+}
+
+// 按UTF-16编码单元的顺序比较两个UTF-8的键（RFC 8785第3.2.3节）
+// UTF-8的字节顺序就是码点顺序，只有U+10000以上的字符（UTF-16中是0xD800起的代理）和U+E000到U+FFFF的字符相反，
+// 这时第一个不同的字节分别是四字节序列的首字节0xF0~0xF4和三字节序列的首字节0xEE、0xEF
+static int canonical_keycmp(const char* a,const char* b){
+    const unsigned char* x = (const unsigned char*)(a ? a : "");
+    const unsigned char* y = (const unsigned char*)(b ? b : "");
+    while (*x && *x == *y)
+    {
+        x++;
+        y++;
+    }
+    if (*x >= 0xF0 && (*y == 0xEE || *y == 0xEF))
+    {
+        return -1;
+    }
+    if (*y >= 0xF0 && (*x == 0xEE || *x == 0xEF))
+    {
+        return 1;
+    }
+    return (int)*x - (int)*y;
+}
+
+// 正在打印的容器：数组记下一个要打印的子结点，对象记排好序的子结点在指针栈中的位置base、个数n和下一个的下标i
+typedef struct {
+    cJSON* node;
+    cJSON* next;
+    size_t base;
+    size_t n;
+    size_t i;
+} canonical_frame;
+
+// 打印过程中的状态：输出缓冲区，给各层对象排序用的结点指针栈，以及正在打印的各层容器
+// 每个对象在栈顶占用2n个位置（n个子结点和归并用的临时空间），打印子结点时只保留排好序的n个，嵌套的对象接着往上放；
+// 两个栈都可能被realloc移动，所以只记下标
+typedef struct {
+    printbuffer p;
+    cJSON** stack;
+    size_t used;
+    size_t size;
+    canonical_frame* frames;
+    size_t depth;
+    size_t capacity;
+} canonical_context;
+
+// 把a[0,n)按键排成稳定的顺序，tmp是同样大小的临时空间，返回排好序的那一块（a或tmp）
+// 自底向上归并，相邻的两段已经有序时直接复制，已经排好序的对象（例如再次规范化）每层只比较一次
+static cJSON** canonical_sort(cJSON** a,cJSON** tmp,size_t n){
+    size_t width,lo,mid,hi,i,j,k;
+    cJSON** t;
+    for (width = 1;width < n;width *= 2)
+    {
+        for (lo = 0;lo < n;lo += 2 * width)
+        {
+            mid = lo + width < n ? lo + width : n;
+            hi = lo + 2 * width < n ? lo + 2 * width : n;
+            if (mid == hi || canonical_keycmp(a[mid - 1]->string,a[mid]->string) <= 0)
+            {
+                memcpy(tmp + lo,a + lo,(hi - lo) * sizeof(cJSON*));
+                continue;
+            }
+            for (i = lo,j = mid,k = lo;i < mid && j < hi;)
+            {
+                tmp[k++] = (canonical_keycmp(a[j]->string,a[i]->string) < 0) ? a[j++] : a[i++];
+            }
+            memcpy(tmp + k,a + i,(mid - i) * sizeof(cJSON*));
+            k += mid - i;
+            memcpy(tmp + k,a + j,(hi - j) * sizeof(cJSON*));
+        }
+        t = a;
+        a = tmp;
+        tmp = t;
+    }
+    return a;
+}
+
+// 开始打印一个值：标量直接写出；非空的容器写出左括号并压入一层，对象的子结点先排好序
+static int canonical_value(cJSON* item,canonical_context* ctx){
+    char* ptr;
+    cJSON* child;
+    cJSON** sorted;
+    cJSON** stack;
+    canonical_frame* frames;
+    canonical_frame* f;
+    size_t base,n = 0,i,size;
+    switch (item->type & 255)
+    {
+    case cJSON_NULL:
+        return print_append(&ctx->p,"null");
+    case cJSON_False:
+        return print_append(&ctx->p,"false");
+    case cJSON_True:
+        return print_append(&ctx->p,"true");
+    case cJSON_Number:
+        // JCS不能表示NaN和无穷大
+        if (item->valuedouble != item->valuedouble || item->valuedouble - item->valuedouble != 0)
+        {
+            return 0;
+        }
+        ptr = ensure(&ctx->p,32);
+        if (!ptr)
+        {
+            return 0;
+        }
+        ctx->p.offset += canonical_number(item->valuedouble,ptr);
+        return 1;
+    case cJSON_String:
+        if (!print_string(item,&ctx->p))
+        {
+            return 0;
+        }
+        ctx->p.offset = update(&ctx->p);
+        return 1;
+    case cJSON_Array:
+    case cJSON_Object:
+        break;
+    default:
+        return 0;
+    }
+    if (!item->child)
+    {
+        return print_append(&ctx->p,(item->type & 255) == cJSON_Array ? "[]" : "{}");
+    }
+    if (ctx->depth == ctx->capacity)
+    {
+        size = ctx->capacity ? ctx->capacity * 2 : 32;
+        frames = (canonical_frame*)mem_realloc(ctx->frames,ctx->capacity * sizeof(canonical_frame),size * sizeof(canonical_frame),MEM_OTHER);
+        if (!frames)
+        {
+            return 0;
+        }
+        ctx->frames = frames;
+        ctx->capacity = size;
+    }
+    f = ctx->frames + ctx->depth++;
+    f->node = item;
+    f->next = item->child;
+    f->base = ctx->used;
+    f->n = 0;
+    f->i = 0;
+    if ((item->type & 255) == cJSON_Array)
+    {
+        return print_append(&ctx->p,"[");
+    }
+    for (child = item->child;child;child = child->next)
+    {
+        n++;
+    }
+    base = ctx->used;
+    if (base + 2 * n > ctx->size)
+    {
+        size = (base + 2 * n) * 2;
+        stack = (cJSON**)mem_realloc(ctx->stack,ctx->size * sizeof(cJSON*),size * sizeof(cJSON*),MEM_OTHER);
+        if (!stack)
+        {
+            return 0;
+        }
+        ctx->stack = stack;
+        ctx->size = size;
+    }
+    for (child = item->child,i = 0;child;child = child->next)
+    {
+        ctx->stack[base + i++] = child;
+    }
+    sorted = canonical_sort(ctx->stack + base,ctx->stack + base + n,n);
+    if (sorted != ctx->stack + base)
+    {
+        memcpy(ctx->stack + base,sorted,n * sizeof(cJSON*));
+    }
+    ctx->used = base + n;
+    f->n = n;
+    return print_append(&ctx->p,"{");
+}
+
+// 不递归：每个打印中的容器占一层，依次打印它的下一个子结点，子结点是容器时压入新的一层，打印完后写出右括号
+static int print_canonical(cJSON* item,canonical_context* ctx){
+    canonical_frame* f;
+    cJSON* child;
+    if (!canonical_value(item,ctx))
+    {
+        return 0;
+    }
+    while (ctx->depth)
+    {
+        f = ctx->frames + ctx->depth - 1;
+        if ((f->node->type & 255) == cJSON_Array)
+        {
+            child = f->next;
+            if (!child)
+            {
+                ctx->depth--;
+                if (!print_append(&ctx->p,"]"))
+                {
+                    return 0;
+                }
+                continue;
+            }
+            f->next = child->next;
+            if (child != f->node->child && !print_append(&ctx->p,","))
+            {
+                return 0;
+            }
+        }else{
+            if (f->i == f->n)
+            {
+                ctx->used = f->base;
+                ctx->depth--;
+                if (!print_append(&ctx->p,"}"))
+                {
+                    return 0;
+                }
+                continue;
+            }
+            child = ctx->stack[f->base + f->i];
+            if ((f->i++ && !print_append(&ctx->p,",")) || !print_string_ptr(child->string,&ctx->p))
+            {
+                return 0;
+            }
+            ctx->p.offset = update(&ctx->p);
+            if (!print_append(&ctx->p,":"))
+            {
+                return 0;
+            }
+        }
+        // canonical_value可能移动frames，f不能再用
+        if (!canonical_value(child,ctx))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+char* cJSON_PrintCanonical(cJSON* item){
+    canonical_context ctx;
+    int ok;
+    if (!item)
+    {
+        return 0;
+    }
+    ctx.p.length = 256;
+    ctx.p.offset = 0;
+    ctx.p.buffer = (char*)mem_alloc(ctx.p.length,MEM_PRINT);
+    if (!ctx.p.buffer)
+    {
+        return 0;
+    }
+    ctx.stack = 0;
+    ctx.used = 0;
+    ctx.size = 0;
+    ctx.frames = 0;
+    ctx.depth = 0;
+    ctx.capacity = 0;
+    ok = print_canonical(item,&ctx);
+    if (ctx.stack)
+    {
+        mem_free(ctx.stack,ctx.size * sizeof(cJSON*),MEM_OTHER);
+    }
+    if (ctx.frames)
+    {
+        mem_free(ctx.frames,ctx.capacity * sizeof(canonical_frame),MEM_OTHER);
+    }
+    if (!ok)
+    {
+        mem_free(ctx.p.buffer,ctx.p.length,MEM_PRINT);
+        return 0;
+    }
+    mem_account(MEM_PRINT,ctx.p.length,0);
+    return ctx.p.buffer;
+}
+
+/* JSONPath：表达式编译一次，查询时按计划线性遍历 */
+
+enum { PATH_NAME, PATH_WILDCARD, PATH_INDEX, PATH_SLICE, PATH_FILTER };
+enum { PATH_EXISTS, PATH_EQ, PATH_NE, PATH_LT, PATH_LE, PATH_GT, PATH_GE };
+
+struct path_filter;
+
+// 编译后的一步：选择器，以及它是否作用于当前结点和所有后代（前面是".."）
+typedef struct {
+    int kind;
+    int descendant;
+    // PATH_NAME的键，已经去掉引号和转义
+    char* name;
+    // PATH_INDEX只用start；PATH_SLICE的start、end没有给出时对应的has_start、has_end为0
+    long start;
+    long end;
+    long step;
+    int has_start;
+    int has_end;
+    struct path_filter* filter;
+} path_step;
+
+// [?(@.a.b op 字面量)]：rel是@后面的相对路径，只有名字和下标；op为PATH_EXISTS时只检查路径是否存在
+typedef struct path_filter {
+    path_step* rel;
+    int relcount;
+    int relcapacity;
+    int op;
+    int negate;
+    int type;
+    double number;
+    char* string;
+} path_filter;
+
+struct cJSON_Path {
+    path_step* steps;
+    int count;
+    int capacity;
+};
+
+// 查询的输出：最多存capacity个，count统计全部的匹配；failed表示".."遍历后代时申请不到栈的内存
+typedef struct {
+    cJSON** results;
+    size_t capacity;
+    size_t count;
+    int failed;
+} path_query;
+
+static void path_free_steps(path_step* steps,int count){
+    int i;
+    for (i = 0;i < count;i++)
+    {
+        if (steps[i].name)
+        {
+            mem_free(steps[i].name,strlen(steps[i].name) + 1,MEM_OTHER);
+        }
+        if (steps[i].filter)
+        {
+            path_free_steps(steps[i].filter->rel,steps[i].filter->relcount);
+            if (steps[i].filter->rel)
+            {
+                mem_free(steps[i].filter->rel,steps[i].filter->relcapacity * sizeof(path_step),MEM_OTHER);
+            }
+            if (steps[i].filter->string)
+            {
+                mem_free(steps[i].filter->string,strlen(steps[i].filter->string) + 1,MEM_OTHER);
+            }
+            mem_free(steps[i].filter,sizeof(path_filter),MEM_OTHER);
+        }
+    }
+}
+
+void cJSON_DeletePath(cJSON_Path* path){
+    if (!path)
+    {
+        return;
+    }
+    path_free_steps(path->steps,path->count);
+    if (path->steps)
+    {
+        mem_free(path->steps,path->capacity * sizeof(path_step),MEM_OTHER);
+    }
+    mem_free(path,sizeof(cJSON_Path),MEM_OTHER);
+}
+
+// 在steps末尾加一个清零的步骤，数组满了就扩大一倍
+static path_step* path_add_step(path_step** steps,int* count,int* capacity){
+    path_step* grown;
+    int size;
+    if (*count == *capacity)
+    {
+        size = *capacity ? *capacity * 2 : 4;
+        grown = (path_step*)mem_realloc(*steps,*capacity * sizeof(path_step),size * sizeof(path_step),MEM_OTHER);
+        if (!grown)
+        {
+            return 0;
+        }
+        *steps = grown;
+        *capacity = size;
+    }
+    memset(*steps + *count,0,sizeof(path_step));
+    return *steps + (*count)++;
+}
+
+static const char* path_skip(const char* p){
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+    {
+        p++;
+    }
+    return p;
+}
+
+// 点号后面的名字：到'.'、'['、空白或者过滤表达式中的运算符为止，允许'-'等字符，例如$.web-app
+static const char* path_name_end(const char* p){
+    while (*p && !strchr(".[]() \t\r\n=!<>&|,",*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+// 复制[start,end)为新申请的字符串
+static char* path_strndup(const char* start,size_t len){
+    char* copy = (char*)mem_alloc(len + 1,MEM_OTHER);
+    if (copy)
+    {
+        memcpy(copy,start,len);
+        copy[len] = 0;
+    }
+    return copy;
+}
+
+// 把引号之后到结尾引号quote之间的内容按path_quoted的规则解码到out（解码后不会比原文长），返回写入的长度
+static size_t path_unescape(const char* p,char quote,char* out){
+    char* ptr = out;
+    for (;*p != quote;p++)
+    {
+        if (*p == '\\')
+        {
+            switch (*++p)
+            {
+            case 'b': *ptr++ = '\b'; break;
+            case 'f': *ptr++ = '\f'; break;
+            case 'n': *ptr++ = '\n'; break;
+            case 'r': *ptr++ = '\r'; break;
+            case 't': *ptr++ = '\t'; break;
+            default: *ptr++ = *p; break;
+            }
+        }else{
+            *ptr++ = *p;
+        }
+    }
+    return ptr - out;
+}
+
+// 单引号或双引号括起来的名字或字面量，支持\\、\'、\"、\/和\b \f \n \r \t，返回引号之后的位置
+static const char* path_quoted(const char* p,char** out){
+    char quote = *p++;
+    const char* start = p;
+    char* ptr;
+    size_t len = 0;
+    for (;*p != quote;p++,len++)
+    {
+        if (!*p)
+        {
+            ep = p;
+            return 0;
+        }
+        if (*p == '\\')
+        {
+            p++;
+            if (!*p || !strchr("\\\'\"/bfnrt",*p))
+            {
+                ep = p;
+                return 0;
+            }
+        }
+    }
+    ptr = *out = (char*)mem_alloc(len + 1,MEM_OTHER);
+    if (!ptr)
+    {
+        return 0;
+    }
+    ptr[path_unescape(start,quote,ptr)] = 0;
+    return p + 1;
+}
+
+// 可选的负号和十进制数字
+static const char* path_integer(const char* p,long* value){
+    int negative = (*p == '-');
+    long v = 0;
+    if (negative)
+    {
+        p++;
+    }
+    if (*p < '0' || *p > '9')
+    {
+        ep = p;
+        return 0;
+    }
+    while (*p >= '0' && *p <= '9')
+    {
+        if (v > (LONG_MAX - 9) / 10)
+        {
+            ep = p;
+            return 0;
+        }
+        v = v * 10 + (*p++ - '0');
+    }
+    *value = negative ? -v : v;
+    return p;
+}
+
+// [?(...)]中的表达式：[!]@相对路径 [运算符 字面量]，括号可以省略
+static const char* path_compile_filter(const char* p,path_step* step){
+    path_filter* f = (path_filter*)mem_alloc(sizeof(path_filter),MEM_OTHER);
+    path_step* rel;
+    int paren;
+    const char* end;
+    static const char* const ops[] = {"==","!=","<=",">=","<",">"};
+    static const int opcodes[] = {PATH_EQ,PATH_NE,PATH_LE,PATH_GE,PATH_LT,PATH_GT};
+    int i;
+    if (!f)
+    {
+        return 0;
+    }
+    memset(f,0,sizeof(path_filter));
+    step->kind = PATH_FILTER;
+    step->filter = f;
+    p = path_skip(p);
+    paren = (*p == '(');
+    if (paren)
+    {
+        p = path_skip(p + 1);
+    }
+    if (*p == '!')
+    {
+        f->negate = 1;
+        p = path_skip(p + 1);
+    }
+    if (*p != '@')
+    {
+        ep = p;
+        return 0;
+    }
+    p++;
+    // 相对路径：.name、['name']、[下标]
+    for (;;)
+    {
+        if (*p == '.')
+        {
+            end = path_name_end(++p);
+            if (end == p || !(rel = path_add_step(&f->rel,&f->relcount,&f->relcapacity)))
+            {
+                ep = p;
+                return 0;
+            }
+            rel->kind = PATH_NAME;
+            if (!(rel->name = path_strndup(p,end - p)))
+            {
+                return 0;
+            }
+            p = end;
+        }else if (*p == '[')
+        {
+            if (!(rel = path_add_step(&f->rel,&f->relcount,&f->relcapacity)))
+            {
+                return 0;
+            }
+            p = path_skip(p + 1);
+            if (*p == '\'' || *p == '\"')
+            {
+                rel->kind = PATH_NAME;
+                p = path_quoted(p,&rel->name);
+            }else{
+                rel->kind = PATH_INDEX;
+                p = path_integer(p,&rel->start);
+            }
+            if (!p)
+            {
+                return 0;
+            }
+            p = path_skip(p);
+            if (*p != ']')
+            {
+                ep = p;
+                return 0;
+            }
+            p++;
+        }else{
+            break;
+        }
+    }
+    p = path_skip(p);
+    for (i = 0;i < 6;i++)
+    {
+        if (!strncmp(p,ops[i],strlen(ops[i])))
+        {
+            f->op = opcodes[i];
+            p = path_skip(p + strlen(ops[i]));
+            break;
+        }
+    }
+    if (f->op)
+    {
+        if (f->negate)
+        {
+            ep = p;
+            return 0;
+        }
+        if (*p == '\'' || *p == '\"')
+        {
+            f->type = cJSON_String;
+            p = path_quoted(p,&f->string);
+        }else if (!strncmp(p,"true",4))
+        {
+            f->type = cJSON_True;
+            p += 4;
+        }else if (!strncmp(p,"false",5))
+        {
+            f->type = cJSON_False;
+            p += 5;
+        }else if (!strncmp(p,"null",4))
+        {
+            f->type = cJSON_NULL;
+            p += 4;
+        }else{
+            f->type = cJSON_Number;
+            p = cJSON_ParseNumberToken(p,&f->number);
+        }
+        if (!p)
+        {
+            return 0;
+        }
+        p = path_skip(p);
+    }
+    if (paren)
+    {
+        if (*p != ')')
+        {
+            ep = p;
+            return 0;
+        }
+        p = path_skip(p + 1);
+    }
+    return p;
+}
+
+// 方括号中的选择器，p指向'['，返回']'之后的位置
+static const char* path_compile_bracket(const char* p,path_step* step){
+    p = path_skip(p + 1);
+    if (*p == '*')
+    {
+        step->kind = PATH_WILDCARD;
+        p = path_skip(p + 1);
+    }else if (*p == '\'' || *p == '\"')
+    {
+        step->kind = PATH_NAME;
+        p = path_quoted(p,&step->name);
+    }else if (*p == '?')
+    {
+        p = path_compile_filter(p + 1,step);
+    }else{
+        // 下标或者切片[start:end:step]，三项都可以省略
+        step->kind = PATH_INDEX;
+        step->step = 1;
+        if (*p != ':')
+        {
+            p = path_integer(p,&step->start);
+            step->has_start = 1;
+        }
+        if (p && *(p = path_skip(p)) == ':')
+        {
+            step->kind = PATH_SLICE;
+            p = path_skip(p + 1);
+            if (*p == '-' || (*p >= '0' && *p <= '9'))
+            {
+                p = path_integer(p,&step->end);
+                step->has_end = 1;
+            }
+            if (p && *(p = path_skip(p)) == ':')
+            {
+                p = path_skip(p + 1);
+                if (*p == '-' || (*p >= '0' && *p <= '9'))
+                {
+                    p = path_integer(p,&step->step);
+                }
+            }
+        }
+    }
+    if (!p)
+    {
+        return 0;
+    }
+    p = path_skip(p);
+    if (*p != ']')
+    {
+        ep = p;
+        return 0;
+    }
+    return p + 1;
+}
+
+cJSON_Path* cJSON_CompilePath(const char* expr){
+    cJSON_Path* path;
+    path_step* step;
+    const char* p = expr;
+    const char* end;
+    int descendant;
+    if (!p || *p != '$')
+    {
+        ep = p;
+        return 0;
+    }
+    path = (cJSON_Path*)mem_alloc(sizeof(cJSON_Path),MEM_OTHER);
+    if (!path)
+    {
+        return 0;
+    }
+    memset(path,0,sizeof(cJSON_Path));
+    p++;
+    while (*p)
+    {
+        if (*p != '.' && *p != '[')
+        {
+            ep = p;
+            goto fail;
+        }
+        step = path_add_step(&path->steps,&path->count,&path->capacity);
+        if (!step)
+        {
+            goto fail;
+        }
+        descendant = 0;
+        if (*p == '.')
+        {
+            p++;
+            if (*p == '.')
+            {
+                descendant = 1;
+                p++;
+            }
+            if (*p == '*')
+            {
+                step->kind = PATH_WILDCARD;
+                p++;
+            }else if (*p == '[' && descendant)
+            {
+                p = path_compile_bracket(p,step);
+            }else{
+                end = path_name_end(p);
+                if (end == p || *end == ']' || *end == ')')
+                {
+                    ep = end;
+                    goto fail;
+                }
+                step->kind = PATH_NAME;
+                step->name = path_strndup(p,end - p);
+                p = step->name ? end : 0;
+            }
+        }else{
+            p = path_compile_bracket(p,step);
+        }
+        step->descendant = descendant;
+        if (!p)
+        {
+            goto fail;
+        }
+    }
+    return path;
+fail:
+    cJSON_DeletePath(path);
+    return 0;
+}
+
+// 过滤条件对结点c是否成立
+static int path_filter_match(const path_filter* f,cJSON* c){
+    int i;
+    long index;
+    int cmp;
+    cJSON* v;
+    for (i = 0;i < f->relcount && c;i++)
+    {
+        if (f->rel[i].kind == PATH_NAME)
+        {
+            if ((c->type & 255) != cJSON_Object)
+            {
+                c = 0;
+                break;
+            }
+            for (c = c->child;c && strcmp(c->string ? c->string : "",f->rel[i].name);c = c->next)
+            {
+            }
+        }else{
+            if ((c->type & 255) != cJSON_Array)
+            {
+                c = 0;
+                break;
+            }
+            index = f->rel[i].start;
+            if (index < 0)
+            {
+                for (v = c->child;v;v = v->next)
+                {
+                    index++;
+                }
+            }
+            for (c = index >= 0 ? c->child : 0;c && index > 0;c = c->next,index--)
+            {
+            }
+        }
+    }
+    if (f->op == PATH_EXISTS)
+    {
+        return (c != 0) != f->negate;
+    }
+    // 类型不同或者路径不存在：只有!=成立
+    if (!c || (f->type == cJSON_Number ? (c->type & 255) != cJSON_Number : (c->type & 255) != f->type))
+    {
+        return f->op == PATH_NE;
+    }
+    if (f->type == cJSON_Number)
+    {
+        cmp = (c->valuedouble < f->number) ? -1 : (c->valuedouble > f->number) ? 1 : 0;
+    }else if (f->type == cJSON_String)
+    {
+        cmp = strcmp(c->valuestring,f->string);
+    }else{
+        // true、false和null只能比较是否相等
+        if (f->op != PATH_EQ && f->op != PATH_NE)
+        {
+            return 0;
+        }
+        cmp = 0;
+    }
+    switch (f->op)
+    {
+    case PATH_EQ: return cmp == 0;
+    case PATH_NE: return cmp != 0;
+    case PATH_LT: return cmp < 0;
+    case PATH_LE: return cmp <= 0;
+    case PATH_GT: return cmp > 0;
+    default: return cmp >= 0;
+    }
+}
+
+static void path_run(const cJSON_Path* path,int i,cJSON* node,path_query* q);
+
+// 数组中下标的结点，不存在时返回0
+static cJSON* path_array_item(cJSON* array,long index,long size){
+    cJSON* c;
+    if (index < 0)
+    {
+        index += size;
+    }
+    if (index < 0 || index >= size)
+    {
+        return 0;
+    }
+    for (c = array->child;c && index > 0;c = c->next,index--)
+    {
+    }
+    return c;
+}
+
+// 对node应用第i步的选择器，每个匹配的结点接着执行后面的步骤
+// 数组只从头到尾（负的步长时从尾到头）走一遍，不按下标逐个查找
+static void path_select(const cJSON_Path* path,int i,cJSON* node,path_query* q){
+    const path_step* s = &path->steps[i];
+    int type = node->type & 255;
+    long size = 0,lower,upper,at,skip;
+    cJSON* c;
+    if (type != cJSON_Array && type != cJSON_Object)
+    {
+        return;
+    }
+    switch (s->kind)
+    {
+    case PATH_NAME:
+        if (type == cJSON_Object)
+        {
+            for (c = node->child;c;c = c->next)
+            {
+                if (c->string && !strcmp(c->string,s->name))
+                {
+                    path_run(path,i + 1,c,q);
+                }
+            }
+        }
+        break;
+    case PATH_WILDCARD:
+        for (c = node->child;c;c = c->next)
+        {
+            path_run(path,i + 1,c,q);
+        }
+        break;
+    case PATH_FILTER:
+        for (c = node->child;c;c = c->next)
+        {
+            if (path_filter_match(s->filter,c))
+            {
+                path_run(path,i + 1,c,q);
+            }
+        }
+        break;
+    default:
+        if (type != cJSON_Array)
+        {
+            break;
+        }
+        for (c = node->child;c;c = c->next)
+        {
+            size++;
+        }
+        if (s->kind == PATH_INDEX)
+        {
+            c = path_array_item(node,s->start,size);
+            if (c)
+            {
+                path_run(path,i + 1,c,q);
+            }
+            break;
+        }
+        // 切片按RFC 9535第2.3.4节的规则确定范围
+        if (s->step > 0)
+        {
+            lower = !s->has_start ? 0 : (s->start < 0 ? s->start + size : s->start);
+            upper = !s->has_end ? size : (s->end < 0 ? s->end + size : s->end);
+            lower = lower < 0 ? 0 : (lower > size ? size : lower);
+            upper = upper < 0 ? 0 : (upper > size ? size : upper);
+            for (c = node->child,at = 0;c && at < lower;c = c->next,at++)
+            {
+            }
+            for (;c && at < upper;)
+            {
+                path_run(path,i + 1,c,q);
+                for (skip = s->step;c && skip > 0;c = c->next,skip--,at++)
+                {
+                }
+            }
+        }else if (s->step < 0)
+        {
+            upper = !s->has_start ? size - 1 : (s->start < 0 ? s->start + size : s->start);
+            lower = !s->has_end ? -1 : (s->end < 0 ? s->end + size : s->end);
+            upper = upper < -1 ? -1 : (upper > size - 1 ? size - 1 : upper);
+            lower = lower < -1 ? -1 : (lower > size - 1 ? size - 1 : lower);
+            c = upper >= 0 ? path_array_item(node,upper,size) : 0;
+            for (at = upper;c && at > lower;)
+            {
+                path_run(path,i + 1,c,q);
+                for (skip = s->step;c && skip < 0;c = c->prev,skip++,at--)
+                {
+                }
+            }
+        }
+        break;
+    }
+}
+
+// 第i步及以后的步骤作用于node，走完所有步骤的结点就是结果
+// ".."的步骤先作用于node自身，再按文档顺序作用于每个后代。后代用显式的栈先序遍历，栈中是每层接下来要访问的结点，
+// 深层的树也不会递归；递归只发生在相邻的步骤之间，深度不超过表达式的步数
+static void path_run(const cJSON_Path* path,int i,cJSON* node,path_query* q){
+    cJSON* local[32];
+    cJSON** stack = local;
+    cJSON** newstack;
+    size_t capacity = sizeof(local) / sizeof(local[0]);
+    size_t depth = 0;
+    cJSON* c;
+    int type;
+    if (i == path->count)
+    {
+        if (q->count < q->capacity)
+        {
+            q->results[q->count] = node;
+        }
+        q->count++;
+        return;
+    }
+    path_select(path,i,node,q);
+    type = node->type & 255;
+    if (!path->steps[i].descendant || (type != cJSON_Array && type != cJSON_Object) || !node->child)
+    {
+        return;
+    }
+    stack[depth++] = node->child;
+    while (depth && !q->failed)
+    {
+        c = stack[--depth];
+        path_select(path,i,c,q);
+        type = c->type & 255;
+        // 兄弟结点先入栈，子结点后入栈，整棵子树访问完后才轮到下一个兄弟
+        if (depth + 2 > capacity)
+        {
+            newstack = (cJSON**)mem_alloc(capacity * 2 * sizeof(cJSON*),MEM_OTHER);
+            if (!newstack)
+            {
+                q->failed = 1;
+                break;
+            }
+            memcpy(newstack,stack,depth * sizeof(cJSON*));
+            if (stack != local)
+            {
+                mem_free(stack,capacity * sizeof(cJSON*),MEM_OTHER);
+            }
+            stack = newstack;
+            capacity *= 2;
+        }
+        if (c->next)
+        {
+            stack[depth++] = c->next;
+        }
+        if ((type == cJSON_Array || type == cJSON_Object) && c->child)
+        {
+            stack[depth++] = c->child;
+        }
+    }
+    if (stack != local)
+    {
+        mem_free(stack,capacity * sizeof(cJSON*),MEM_OTHER);
+    }
+}
+
+size_t cJSON_PathQuery(const cJSON_Path* path,cJSON* root,cJSON** results,size_t capacity){
+    path_query q;
+    if (!path || !root)
+    {
+        return 0;
+    }
+    q.results = results;
+    q.capacity = results ? capacity : 0;
+    q.count = 0;
+    q.failed = 0;
+    path_run(path,0,root,&q);
+    return q.failed ? 0 : q.count;
+}
+
+/* 投影解析：只为选中的字段建立结点，其余的值只扫描括号和引号跳过 */
+
+// 投影是一棵前缀树，每个结点对应路径中的一步：键（PATH_NAME）、数组下标（PATH_INDEX）或者通配符（PATH_WILDCARD）
+// keep表示某条路径在这里结束，整个子树都要保留
+typedef struct {
+    int kind;
+    char* name;
+    size_t len;
+    long index;
+    int keep;
+    int child;
+    int next;
+} projection_node;
+
+struct cJSON_Projection {
+    projection_node* nodes;
+    int count;
+    int capacity;
+};
+
+void cJSON_DeleteProjection(cJSON_Projection* projection){
+    int i;
+    if (!projection)
+    {
+        return;
+    }
+    for (i = 0;i < projection->count;i++)
+    {
+        if (projection->nodes[i].name)
+        {
+            mem_free(projection->nodes[i].name,projection->nodes[i].len + 1,MEM_OTHER);
+        }
+    }
+    if (projection->nodes)
+    {
+        mem_free(projection->nodes,projection->capacity * sizeof(projection_node),MEM_OTHER);
+    }
+    mem_free(projection,sizeof(cJSON_Projection),MEM_OTHER);
+}
+
+// 在投影中加一个结点，作为parent的最后一个子结点，返回它的下标，失败时返回-1
+static int projection_add(cJSON_Projection* proj,int parent,const path_step* step){
+    projection_node* grown;
+    projection_node* n;
+    int size;
+    int i;
+    if (proj->count == proj->capacity)
+    {
+        size = proj->capacity ? proj->capacity * 2 : 8;
+        grown = (projection_node*)mem_realloc(proj->nodes,proj->capacity * sizeof(projection_node),size * sizeof(projection_node),MEM_OTHER);
+        if (!grown)
+        {
+            return -1;
+        }
+        proj->nodes = grown;
+        proj->capacity = size;
+    }
+    n = &proj->nodes[proj->count];
+    memset(n,0,sizeof(projection_node));
+    n->child = -1;
+    n->next = -1;
+    if (step)
+    {
+        n->kind = step->kind;
+        n->index = step->start;
+        if (step->kind == PATH_NAME)
+        {
+            n->len = strlen(step->name);
+            if (!(n->name = path_strndup(step->name,n->len)))
+            {
+                return -1;
+            }
+        }
+    }
+    proj->count++;
+    if (parent >= 0)
+    {
+        if (proj->nodes[parent].child < 0)
+        {
+            proj->nodes[parent].child = proj->count - 1;
+        }else{
+            for (i = proj->nodes[parent].child;proj->nodes[i].next >= 0;i = proj->nodes[i].next)
+            {
+            }
+            proj->nodes[i].next = proj->count - 1;
+        }
+    }
+    return proj->count - 1;
+}
+
+// 第pos步的选择器a是否也选中b选中的值：相同的键或下标，或者a是通配符
+static int projection_covers(const path_step* a,const path_step* b){
+    if (a->kind == PATH_WILDCARD)
+    {
+        return 1;
+    }
+    if (a->kind != b->kind)
+    {
+        return 0;
+    }
+    return a->kind == PATH_NAME ? !strcmp(a->name,b->name) : a->start == b->start;
+}
+
+// 把active中的路径从第pos步开始的部分建到结点node之下
+// 每个不同的键和下标各建一个子结点，通配符的路径同时并入这些子结点，所以解析时每个值只对应一个投影结点
+static int projection_build(cJSON_Projection* proj,int node,cJSON_Path** paths,const int* active,int count,int pos){
+    int* subset;
+    int i;
+    int j;
+    int k;
+    int n;
+    int child;
+    int ok = 1;
+    const path_step* step;
+    for (i = 0;i < count;i++)
+    {
+        if (paths[active[i]]->count == pos)
+        {
+            proj->nodes[node].keep = 1;
+            return 1;
+        }
+    }
+    subset = (int*)mem_alloc(count * sizeof(int),MEM_OTHER);
+    if (!subset)
+    {
+        return 0;
+    }
+    for (i = 0;i < count && ok;i++)
+    {
+        step = &paths[active[i]]->steps[pos];
+        // 同样的选择器已经在前面的路径中处理过
+        for (j = 0;j < i;j++)
+        {
+            if (projection_covers(&paths[active[j]]->steps[pos],step) && projection_covers(step,&paths[active[j]]->steps[pos]))
+            {
+                break;
+            }
+        }
+        if (j < i)
+        {
+            continue;
+        }
+        for (k = 0,n = 0;k < count;k++)
+        {
+            if (projection_covers(&paths[active[k]]->steps[pos],step))
+            {
+                subset[n++] = active[k];
+            }
+        }
+        child = projection_add(proj,node,step);
+        ok = child >= 0 && projection_build(proj,child,paths,subset,n,pos + 1);
+    }
+    mem_free(subset,count * sizeof(int),MEM_OTHER);
+    return ok;
+}
+
+cJSON_Projection* cJSON_CreateProjection(const char* const* paths,int count){
+    cJSON_Projection* proj;
+    cJSON_Path** compiled;
+    int* active;
+    int i;
+    int j;
+    int ok = 1;
+    if (!paths || count <= 0)
+    {
+        return 0;
+    }
+    proj = (cJSON_Projection*)mem_alloc(sizeof(cJSON_Projection),MEM_OTHER);
+    compiled = (cJSON_Path**)mem_alloc(count * sizeof(cJSON_Path*),MEM_OTHER);
+    active = (int*)mem_alloc(count * sizeof(int),MEM_OTHER);
+    if (!proj || !compiled || !active)
+    {
+        ok = 0;
+        count = 0;
+    }else{
+        memset(proj,0,sizeof(cJSON_Projection));
+        memset(compiled,0,count * sizeof(cJSON_Path*));
+    }
+    // 投影只支持键、非负的下标和通配符，这样在解析时看到键或者数到下标就能决定要不要这个值
+    for (i = 0;i < count && ok;i++)
+    {
+        active[i] = i;
+        compiled[i] = cJSON_CompilePath(paths[i]);
+        if (!compiled[i])
+        {
+            ok = 0;
+            break;
+        }
+        for (j = 0;j < compiled[i]->count;j++)
+        {
+            const path_step* step = &compiled[i]->steps[j];
+            if (step->descendant || step->kind == PATH_SLICE || step->kind == PATH_FILTER || (step->kind == PATH_INDEX && step->start < 0))
+            {
+                ep = paths[i];
+                ok = 0;
+                break;
+            }
+        }
+    }
+    ok = ok && projection_add(proj,-1,0) == 0 && projection_build(proj,0,compiled,active,count,0);
+    for (i = 0;i < count;i++)
+    {
+        cJSON_DeletePath(compiled[i]);
+    }
+    if (compiled)
+    {
+        mem_free(compiled,count * sizeof(cJSON_Path*),MEM_OTHER);
+    }
+    if (active)
+    {
+        mem_free(active,count * sizeof(int),MEM_OTHER);
+    }
+    if (!ok)
+    {
+        cJSON_DeleteProjection(proj);
+        return 0;
+    }
+    return proj;
+}
+
+// 键（开头的引号之后，长度为len，未解码）在结点node之下对应的投影结点，没有时返回-1
+static int projection_member(const cJSON_Projection* proj,int node,const char* key,size_t len){
+    char local[256];
+    char* decoded = 0;
+    char* end;
+    int found = -1;
+    int c;
+    int n = 0;
+    // 带转义字符的键先解码
+    if (memchr(key,'\\',len))
+    {
+        n = string_length(key);
+        decoded = n < (int)sizeof(local) ? local : (char*)mem_alloc(n + 1,MEM_OTHER);
+        if (!decoded)
+        {
+            return -1;
+        }
+        decode_string(key,decoded,&end);
+        key = decoded;
+        len = end - decoded;
+    }
+    for (c = proj->nodes[node].child;c >= 0;c = proj->nodes[c].next)
+    {
+        const projection_node* p = &proj->nodes[c];
+        if (p->kind == PATH_NAME && p->len == len && !memcmp(p->name,key,len))
+        {
+            found = c;
+            break;
+        }
+        if (p->kind == PATH_WILDCARD)
+        {
+            found = c;
+        }
+    }
+    if (decoded && decoded != local)
+    {
+        mem_free(decoded,n + 1,MEM_OTHER);
+    }
+    return found;
+}
+
+// 数组中第index个元素对应的投影结点，没有时返回-1
+static int projection_element(const cJSON_Projection* proj,int node,long index){
+    int found = -1;
+    int c;
+    for (c = proj->nodes[node].child;c >= 0;c = proj->nodes[c].next)
+    {
+        if (proj->nodes[c].kind == PATH_INDEX && proj->nodes[c].index == index)
+        {
+            return c;
+        }
+        if (proj->nodes[c].kind == PATH_WILDCARD)
+        {
+            found = c;
+        }
+    }
+    return found;
+}
+
+// 按投影结点node解析一个值到item中。整个保留的子树交给parse_value（不递归）；
+// 只有中间的数组和对象在这里逐个成员判断，递归的层数不超过最长的路径
+// 不需要的值用skip_value跳过，不建结点也不解码字符串；路径经过的标量没有选中的内容，也跳过
+static const char* parse_projected(cJSON* item,const char* value,parse_context* ctx,const cJSON_Projection* proj,int node){
+    int object = (*value == '{');
+    int constkeys = ctx->pool ? cJSON_StringIsConst : 0;
+    int keyflag;
+    int match;
+    long index = 0;
+    const char* key = 0;
+    const char* end;
+    cJSON* child;
+    cJSON* tail = 0;
+    if (proj->nodes[node].keep || (*value != '{' && *value != '['))
+    {
+        return parse_value(item,value,ctx);
+    }
+    item->type = object ? cJSON_Object : cJSON_Array;
+    value = skip(value + 1);
+    if (*value == (object ? '}' : ']'))
+    {
+        return value + 1;
+    }
+    for (;;)
+    {
+        if (object)
+        {
+            if (*value != '\"' || !(end = skip_string(value)))
+            {
+                ep = value;
+                return 0;
+            }
+            key = value;
+            match = projection_member(proj,node,value + 1,end - value - 2);
+            value = skip(end);
+            if (*value != ':')
+            {
+                ep = value;
+                return 0;
+            }
+            value = skip(value + 1);
+        }else{
+            match = projection_element(proj,node,index++);
+        }
+        if (match < 0 || (!proj->nodes[match].keep && *value != '{' && *value != '['))
+        {
+            value = skip_value(value);
+        }else{
+            child = cJSON_New_Item();
+            if (!child)
+            {
+                return 0;
+            }
+            if (tail)
+            {
+                suffix_object(tail,child);
+            }else{
+                item->child = child;
+            }
+            tail = child;
+            keyflag = 0;
+            if (object)
+            {
+                // 键在原文中已经检查过引号，这里解码（使用字符串池时放入池中）
+                if (!parse_key(child,key,ctx))
+                {
+                    return 0;
+                }
+                keyflag = constkeys;
+                child->type = keyflag;
+            }
+            value = parse_projected(child,value,ctx,proj,match);
+            child->type |= keyflag;
+        }
+        if (!value)
+        {
+            return 0;
+        }
+        value = skip(value);
+        if (*value == ',')
+        {
+            value = skip(value + 1);
+            continue;
+        }
+        if (*value == (object ? '}' : ']'))
+        {
+            return value + 1;
+        }
+        ep = value;
+        return 0;
+    }
+}
+
+cJSON* cJSON_ParseProjected(const char* value,const cJSON_Projection* projection){
+    parse_context ctx = {0};
+    const char* end;
+    cJSON* c;
+    ep = 0;
+    if (!value || !projection)
+    {
+        return 0;
+    }
+    c = cJSON_New_Item();
+    if (!c)
+    {
+        return 0;
+    }
+    ctx.pool = intern_pool;
+    ctx.strict = strict_strings;
+    if (ctx.strict)
+    {
+        ctx.end = value + strlen(value);
+    }
+    end = parse_projected(c,skip(value),&ctx,projection,0);
+    if (!end)
+    {
+        cJSON_Delete(c);
+        return 0;
+    }
+    return c;
+}
+
+/* 多路径提取：一次顺序扫描原文取出若干路径上的值，不建树也不申请内存 */
+
+// 路径中的一步：键（name指向路径原文中的名字，quote不为0时是引号中可能带转义的内容）或者下标（name为0）
+typedef struct extract_step
+{
+    const char* name;
+    size_t len;
+    char quote;
+    long index;
+} extract_step;
+
+typedef struct extract_context
+{
+    cJSON_Extracted* results;
+    int count;
+    int pending;
+} extract_context;
+
+// 读出p（指向'.'或者'['）开始的一步，返回这一步之后的位置；只支持键和非负的下标，其他写法返回0并设置ep
+static const char* extract_next(const char* p,extract_step* step){
+    const char* end;
+    memset(step,0,sizeof(extract_step));
+    if (*p == '.')
+    {
+        end = path_name_end(++p);
+        if (end == p || *p == '*' || *end == ']' || *end == ')')
+        {
+            ep = p;
+            return 0;
+        }
+        step->name = p;
+        step->len = end - p;
+        return end;
+    }
+    p = path_skip(p + 1);
+    if (*p == '\'' || *p == '\"')
+    {
+        // 和path_quoted一样检查转义，名字留在原文中，比较时再解码
+        step->quote = *p++;
+        step->name = p;
+        for (;*p != step->quote;p++)
+        {
+            if (!*p || (*p == '\\' && (!*++p || !strchr("\\\'\"/bfnrt",*p))))
+            {
+                ep = p;
+                return 0;
+            }
+        }
+        step->len = p - step->name;
+        p++;
+    }else{
+        if (*p == '-')
+        {
+            ep = p;
+            return 0;
+        }
+        p = path_integer(p,&step->index);
+        if (!p)
+        {
+            return 0;
+        }
+    }
+    p = path_skip(p);
+    if (*p != ']')
+    {
+        ep = p;
+        return 0;
+    }
+    return p + 1;
+}
+
+// 路径中的名字和对象的键（开头的引号之后，长度为len，未解码）是否相同，两边都没有转义字符时直接比较原文
+// 带转义的一方解码到栈上的缓冲区再比较，解码后放不下的当作不相同，字段名通常远比这短
+static int extract_name_equal(const extract_step* step,const char* key,size_t len,int escaped){
+    char name[256];
+    char decoded[256];
+    char* end;
+    const char* s = step->name;
+    size_t n = step->len;
+    if (step->quote && memchr(s,'\\',n))
+    {
+        if (n >= sizeof(name))
+        {
+            return 0;
+        }
+        n = path_unescape(s,step->quote,name);
+        s = name;
+    }
+    if (escaped)
+    {
+        if (string_length(key) >= (int)sizeof(decoded))
+        {
+            return 0;
+        }
+        decode_string(key,decoded,&end);
+        key = decoded;
+        len = end - decoded;
+    }
+    return n == len && !memcmp(s,key,len);
+}
+
+// 扫描value开始的一个值，路径走到这里（已经匹配了depth步）的结果在results中。
+// 扫描期间results[i]还没找到时（type为-1），start是路径中下一步的位置（不会再匹配时为0），length是已经匹配的步数。
+// 只有某条路径选中的成员才递归进去，其余的用skip_value跳过，递归的层数不超过最长的路径；
+// 所有路径都有了结果后立即返回，不再看后面的文本
+static const char* extract_value(extract_context* ctx,const char* value,size_t depth){
+    cJSON_Extracted* r = ctx->results;
+    cJSON item;
+    parse_context pctx = {0};
+    extract_step step;
+    const char* start = value;
+    const char* key = 0;
+    const char* end;
+    const char* next;
+    size_t len = 0;
+    long index = 0;
+    int object = (*value == '{');
+    int escaped = 0;
+    int live = 0;
+    int hit;
+    int i;
+    memset(&item,0,sizeof(cJSON));
+    // 还需要往下走的路径
+    for (i = 0;i < ctx->count;i++)
+    {
+        if (r[i].type < 0 && r[i].start && r[i].length == depth && *r[i].start)
+        {
+            live++;
+        }
+    }
+    if (live && (*value == '{' || *value == '['))
+    {
+        item.type = object ? cJSON_Object : cJSON_Array;
+        value = skip(value + 1);
+        while (*value != (object ? '}' : ']'))
+        {
+            if (object)
+            {
+                if (*value != '\"' || !(end = skip_string(value)))
+                {
+                    ep = value;
+                    return 0;
+                }
+                key = value + 1;
+                len = end - value - 2;
+                escaped = memchr(key,'\\',len) != 0;
+                value = skip(end);
+                if (*value != ':')
+                {
+                    ep = value;
+                    return 0;
+                }
+                value = skip(value + 1);
+            }
+            hit = 0;
+            for (i = 0;i < ctx->count && live;i++)
+            {
+                if (r[i].type >= 0 || !r[i].start || r[i].length != depth || !*r[i].start)
+                {
+                    continue;
+                }
+                // 路径在cJSON_Extract中已经检查过，这里不会出错
+                next = extract_next(r[i].start,&step);
+                if (object ? (step.name && extract_name_equal(&step,key,len,escaped)) : (!step.name && step.index == index))
+                {
+                    r[i].start = next;
+                    r[i].length = depth + 1;
+                    live--;
+                    hit = 1;
+                }
+            }
+            index++;
+            if (hit)
+            {
+                value = extract_value(ctx,value,depth + 1);
+                if (value && !ctx->pending)
+                {
+                    return value;
+                }
+            }else{
+                value = skip_value(value);
+            }
+            if (!value)
+            {
+                return 0;
+            }
+            value = skip(value);
+            if (*value == ',')
+            {
+                value = skip(value + 1);
+                if (*value == (object ? '}' : ']'))
+                {
+                    ep = value;
+                    return 0;
+                }
+            }else if (*value != (object ? '}' : ']'))
+            {
+                ep = value;
+                return 0;
+            }
+        }
+        end = value + 1;
+    }else if (*value == '\"')
+    {
+        // 字符串不解码，只找到结尾的引号
+        item.type = cJSON_String;
+        end = skip_string(value);
+        if (!end)
+        {
+            ep = value;
+        }
+    }else if (*value == '{' || *value == '[')
+    {
+        // 选中的数组和对象只返回原文中的范围，skip_value检查了括号配对、逗号和冒号，范围不会是残缺的文本
+        item.type = object ? cJSON_Object : cJSON_Array;
+        end = skip_value(value);
+    }else{
+        // 数字和true/false/null不需要申请内存，直接用parse_scalar解析到栈上的结点
+        end = parse_scalar(&item,value,&pctx);
+    }
+    if (!end)
+    {
+        return 0;
+    }
+    for (i = 0;i < ctx->count;i++)
+    {
+        if (r[i].type >= 0 || !r[i].start || r[i].length != depth)
+        {
+            continue;
+        }
+        if (*r[i].start)
+        {
+            // 路径还有下一步，但这个值中没有对应的成员，以后也不会再遇到
+            r[i].start = 0;
+        }else{
+            r[i].type = item.type & 255;
+            r[i].valueint = item.valuedoint;
+            r[i].valuedouble = (item.type & 255) == cJSON_Number ? item.valuedouble : 0;
+            r[i].start = start;
+            r[i].length = end - start;
+            if (item.type == cJSON_String)
+            {
+                r[i].start++;
+                r[i].length -= 2;
+                r[i].escaped = memchr(r[i].start,'\\',r[i].length) != 0;
+            }
+        }
+        ctx->pending--;
+    }
+    return end;
+}
+
+int cJSON_Extract(const char* value,const char* const* paths,int count,cJSON_Extracted* results){
+    extract_context ctx;
+    extract_step step;
+    const char* p;
+    int found = 0;
+    int i;
+    ep = 0;
+    if (!value || count < 0 || (count && (!paths || !results)))
+    {
+        return -1;
+    }
+    // 先检查所有的路径，有错误时不扫描原文
+    for (i = 0;i < count;i++)
+    {
+        p = paths[i];
+        if (!p || *p != '$')
+        {
+            ep = p;
+            return -1;
+        }
+        for (p++;*p;)
+        {
+            if (*p != '.' && *p != '[')
+            {
+                ep = p;
+                return -1;
+            }
+            p = extract_next(p,&step);
+            if (!p)
+            {
+                return -1;
+            }
+        }
+        memset(&results[i],0,sizeof(cJSON_Extracted));
+        results[i].type = -1;
+        results[i].start = paths[i] + 1;
+    }
+    ctx.results = results;
+    ctx.count = count;
+    ctx.pending = count;
+    if (count && !extract_value(&ctx,skip(value),0))
+    {
+        found = -1;
+    }
+    // 清掉没有找到的路径留下的扫描状态
+    for (i = 0;i < count;i++)
+    {
+        if (results[i].type < 0)
+        {
+            results[i].start = 0;
+            results[i].length = 0;
+        }else if (found >= 0)
+        {
+            found++;
+        }
+    }
+    return found;
+}
+
+char* cJSON_ExtractedString(const cJSON_Extracted* result,char* buffer,size_t size){
+    char* end;
+    if (!result || !buffer || result->type != cJSON_String || size <= result->length)
+    {
+        return 0;
+    }
+    if (!result->escaped)
+    {
+        memcpy(buffer,result->start,result->length);
+        buffer[result->length] = 0;
+        return buffer;
+    }
+    decode_string(result->start,buffer,&end);
+    return buffer;
+}
@@ -2,6 +2,8 @@
 #ifndef cjson__h
 #define cjson__h
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 // 兼容C语言
 extern "C"
@@ -17,9 +19,48 @@ extern "C"
 #define cJSON_Array 5
 #define cJSON_Object 6
 
+/* Default limit on how deeply arrays and objects may nest when parsing text. */
+#ifndef CJSON_NESTING_LIMIT
+#define CJSON_NESTING_LIMIT 1000
+#endif
+
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
+// 根节点持有cJSON_ParseFile建立的文件映射，cJSON_Delete时释放
+#define cJSON_OwnsMapping 1024
+// 数组或对象的valuedouble中存放着cJSON_CacheHash算出的哈希
+#define cJSON_HashValid 2048
+
+#ifdef CJSON_COMPACT
+// 结点内部可以直接存放的字符串字节数（包括结尾的'\0'），键和值共用；加上refcount后正好用满72字节结点的对齐空间
+#define cJSON_InlineSize 20
+
+// 匿名union是C11（和C++）的特性。C99下GCC和Clang用__extension__接受它，-pedantic也不会警告；其他只支持C99的编译器不能使用紧凑布局
+#if defined(__GNUC__) && !defined(__cplusplus) && (!defined(__STDC_VERSION__) || __STDC_VERSION__ < 201112L)
+#define CJSON_ANONYMOUS_UNION __extension__
+#else
+#define CJSON_ANONYMOUS_UNION
+#endif
 
+// 紧凑布局：数值和字符串不会同时使用，放进同一个匿名union；短的键和字符串值直接存放在inlinebuf中，
+// string/valuestring仍然是指针（可能指向inlinebuf），所以按字段名访问的代码不需要修改。
+// 注意valuestring和valuedouble共用内存，只有type为cJSON_String时valuestring才有意义
+typedef struct cJSON
+{
+    struct cJSON *next,*prev;
+    struct cJSON *child;
+    int type;
+    int valuedoint;
+    CJSON_ANONYMOUS_UNION union
+    {
+        double valuedouble;
+        char* valuestring;
+    };
+    char* string;
+    int refcount;
+    char inlinebuf[cJSON_InlineSize];
+} cJSON;
+#else
 typedef struct cJSON
 {
     // next指向下一条json数据，prev指向上一条json数据
@@ -28,6 +69,8 @@ typedef struct cJSON
     struct cJSON *child;
     // json数据类型，值为宏定义
     int type;
+    // 写时复制：本结点作为链表头时，除了父结点之外还有多少个容器共享这条子结点链表（使用type后面的对齐空间，不增加结点大小），用原子操作增减
+    int refcount;
     // json数据类型为字符串类型，存储字符串
     char* valuestring;
     // json数据类型为number类型时，存储数据
@@ -36,14 +79,70 @@ typedef struct cJSON
     // 键值的名字
     char* string;
 } cJSON;
+#endif
 
 typedef struct cJSON_Hooks {
       void *(*malloc_fn)(size_t sz);
       void (*free_fn)(void *ptr);
+      /* Optional. Used to grow print and binary output buffers in place. When it is 0, the C library realloc is used
+       * if malloc_fn and free_fn are the C library ones too; otherwise buffers grow by malloc, copy and free. */
+      void *(*realloc_fn)(void *ptr, size_t sz);
 } cJSON_Hooks;
 
 /* Supply malloc, realloc and free functions to cJSON */
 extern void cJSON_InitHooks(cJSON_Hooks* hooks);
+/* Free a buffer returned by the library (cJSON_Print*, binary and snapshot output) through the free hook. */
+extern void cJSON_Free(void* ptr);
+
+/* Key interning pool. While a pool is in use, object keys created by parsing, cJSON_AddItemToObject,
+ * cJSON_ReplaceItemInObject and cJSON_Duplicate point into the pool and are flagged cJSON_StringIsConst,
+ * so repeated keys are stored once. A pool can serve one document or be shared by many; delete it only
+ * after every tree that uses it has been deleted. A pool is not synchronised: keep it on one thread at a time
+ * (give each worker thread its own pool) or serialise every parse and edit that may add keys to it. */
+typedef struct cJSON_InternPool cJSON_InternPool;
+typedef struct cJSON_InternStats
+{
+    size_t strings;      /* distinct keys stored in the pool */
+    size_t bytes;        /* memory held by the pool for key text */
+    size_t hits;         /* lookups answered by an existing key */
+    size_t saved_bytes;  /* key bytes that were not allocated thanks to those hits */
+} cJSON_InternStats;
+
+extern cJSON_InternPool* cJSON_CreateInternPool(void);
+extern void cJSON_DeleteInternPool(cJSON_InternPool* pool);
+/* Make pool the active pool of the calling thread (0 turns interning off). Returns the previous one. */
+extern cJSON_InternPool* cJSON_UseInternPool(cJSON_InternPool* pool);
+extern void cJSON_GetInternStats(const cJSON_InternPool* pool,cJSON_InternStats* stats);
+
+/* Memory statistics. While a stats block is in use on a thread, every allocation and free the library makes on that thread
+ * is charged to it; with none in use (the default) nothing is counted. Node bytes are exact. String and print buffer bytes
+ * count the text held (length + 1), which can be a little less than what was requested from the allocator. Buffers returned
+ * to the caller (cJSON_Print*, binary and snapshot output) leave the accounting when they are returned; their totals still
+ * include them. Trees should be freed under the same stats block that allocated them, otherwise its live counts drift;
+ * this includes trees handed to cJSON_DeleteDeferred, which are freed on the reclaimer thread and not counted. */
+typedef struct cJSON_MemoryStats
+{
+    size_t allocs;               /* calls to the malloc hook */
+    size_t frees;                /* calls to the free hook */
+    size_t reallocs;             /* calls to the realloc hook */
+    size_t live_bytes;           /* node_bytes + string_bytes + print_bytes + other_bytes */
+    size_t peak_bytes;           /* highest live_bytes seen */
+    size_t node_bytes;           /* live bytes by kind */
+    size_t string_bytes;         /* keys, values and key pools */
+    size_t print_bytes;          /* text and binary output still being built */
+    size_t other_bytes;          /* parser stacks and other scratch memory */
+    size_t total_node_bytes;     /* bytes ever charged, by kind: what a piece of work cost */
+    size_t total_string_bytes;
+    size_t total_print_bytes;
+    size_t total_other_bytes;
+} cJSON_MemoryStats;
+
+/* Make stats the stats block of the calling thread (0 stops counting). Returns the previous one. Zero a block to reset it. */
+extern cJSON_MemoryStats* cJSON_UseMemoryStats(cJSON_MemoryStats* stats);
+/* Bytes of memory owned by the tree rooted at item (not its siblings): nodes plus the strings they own, and the file mapping
+ * of a cJSON_ParseFile root. In-place strings, pooled keys and the inline part of compact nodes add nothing. Child lists shared
+ * through cJSON_DuplicateShared are counted in every tree that reaches them. */
+extern size_t cJSON_MemoryUsage(const cJSON* item);
 
 #define cJSON_AddNullToObject(object,name)		cJSON_AddItemToObject(object, name, cJSON_CreateNull())
 #define cJSON_AddTrueToObject(object,name)		cJSON_AddItemToObject(object, name, cJSON_CreateTrue())
@@ -55,6 +154,11 @@ extern void cJSON_InitHooks(cJSON_Hooks* hooks);
 /* When assigning an integer value, it needs to be propagated to valuedouble too. */
 #define cJSON_SetIntValue(object,val)			((object)?(object)->valuedoint=(object)->valuedouble=(val):(val))
 #define cJSON_SetNumberValue(object,val)		((object)?(object)->valuedoint=(object)->valuedouble=(val):(val))
+/* Replace the value of a string node with a copy of valuestring and return the copy. Use it instead of assigning
+ * valuestring: it frees the old value (unless it pointed into a cJSON_ParseInSitu buffer or a mapped file) and, in the
+ * compact layout, reuses the inline buffer when the new value fits. Returns 0, leaving the node unchanged, when object is
+ * not a string node or memory runs out. In a cJSON_DuplicateShared tree, reach the node through the *Mutable getters. */
+extern char *cJSON_SetValuestring(cJSON *object,const char *valuestring);
 
 /* These calls create a cJSON item of the appropriate type. */
 extern cJSON *cJSON_CreateNull(void);
@@ -80,10 +184,23 @@ extern void	cJSON_AddItemToObject(cJSON *object,const char *string,cJSON *item);
 extern char *cJSON_Print(cJSON *item);
 /* Render a cJSON entity to text for transfer/storage without any formatting. Free the char* when finished. */
 extern char *cJSON_PrintUnformatted(cJSON *item);
-/* Render a cJSON entity to text using a buffered strategy. prebuffer is a guess at the final size. guessing well reduces reallocation. fmt=0 gives unformatted, =1 gives formatted */
+/* Render a cJSON entity to text using a buffered strategy. prebuffer is a guess at the final size. guessing well reduces reallocation. fmt=0 gives unformatted, =1 gives formatted.
+ * Any prebuffer works (values <= 0 pick a default); the buffer doubles through the realloc hook when the guess is too small. */
 extern char *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt);
 
+/* Delete a cJSON entity and all subentities. Does not recurse, so arbitrarily deep trees are safe. */
 extern void cJSON_Delete(cJSON *c);
+/* Deferred deletion: while the reclaimer thread is running, cJSON_DeleteDeferred pushes the tree onto a lock-free queue
+ * and returns at once; the reclaimer frees it later. Without a running reclaimer it is plain cJSON_Delete.
+ * The free hook is then called from the reclaimer thread, so it must be thread-safe. Trees passed in must not be touched again,
+ * and trees sharing child lists (cJSON_DuplicateShared) with live trees should be deleted on their owning thread instead.
+ * cJSON_StartReclaimer returns 1 on success (0 where threads are unsupported); cJSON_StopReclaimer frees everything queued and joins the thread,
+ * and must not race with cJSON_DeleteDeferred calls. On Linux the reclaimer runs under SCHED_IDLE, so it only gets CPU time
+ * no other thread wants: while the CPUs stay saturated it can starve and queued trees keep their memory until load drops.
+ * Use plain cJSON_Delete where memory must come back promptly. */
+extern int cJSON_StartReclaimer(void);
+extern void cJSON_StopReclaimer(void);
+extern void cJSON_DeleteDeferred(cJSON *c);
 extern void cJSON_DeleteItemFromArray(cJSON* array,int which);
 extern void cJSON_DeleteItemFromObject(cJSON *object,const char* string);
 extern cJSON* cJSON_DetachItemFromArray(cJSON *array,int which);
@@ -93,16 +210,259 @@ extern cJSON* cJSON_DetachItemFromObject(cJSON *object,const char *string);
 extern cJSON* cJSON_ParseWithOpts(const char* value,const char** return_parse_end,int require_null_terminated);
 
 extern cJSON* cJSON_Parse(const char* value);
+/* The text parser does not recurse; it keeps its own container stack. Documents nesting deeper than the limit
+ * (CJSON_NESTING_LIMIT by default) fail as soon as the limit is crossed, with the error pointer at the offending bracket.
+ * Applies to the calling thread; returns the previous limit. */
+extern size_t cJSON_SetNestingLimit(size_t limit);
+/* Strict string decoding for the text parsers, off by default. When on, every string and key must be valid UTF-8 (no
+ * overlong forms, surrogates or code points above U+10FFFF), contain no raw control characters, use only the escapes of
+ * RFC 8259 with \u surrogates in pairs, not contain \u0000 (it cannot be kept in a NUL-terminated string), and be
+ * terminated; otherwise parsing fails with cJSON_GetErrorPtr at the offending byte (the backslash of a bad escape).
+ * When off, bytes are taken as they are, unknown escapes are copied without the backslash, and \u0000 and unpaired
+ * surrogates are dropped. Numbers and whitespace are not affected; cJSON_Validate checks the whole grammar.
+ * Applies to the calling thread; returns the previous setting. */
+extern int cJSON_SetStrictStrings(int strict);
+/* Parse a writable buffer in place. Strings are decoded inside value and the tree points into it, so value must outlive the tree. */
+extern cJSON* cJSON_ParseInSitu(char* value);
+/* Parse a file in place through a private memory mapping, without an fread copy or a heap allocation per string. The file needs no
+ * terminating NUL. Strings in the returned tree point into the mapping, which is released by cJSON_Delete on the returned root.
+ * Pages the parser writes to become private copies, so resident memory still holds about one copy of the file. */
+extern cJSON* cJSON_ParseFile(const char* path);
 
 extern const char* cJSON_GetErrorPtr(void);
 
+/* Typed accessors. They work with both node layouts; with CJSON_COMPACT valuestring and valuedouble share storage, so check the type first. */
+extern const char* cJSON_GetStringValue(const cJSON* item);
+extern double cJSON_GetNumberValue(const cJSON* item);
+
 extern int cJSON_GetArraySize(cJSON *array);
 extern cJSON* cJSON_GetArrayItem(cJSON* array,int item);
+extern cJSON* cJSON_GetObjectItem(cJSON* object,const char* string);
 extern void cJSON_InsertItemInArray(cJSON* array,int which,cJSON* newitem);
 extern void cJSON_ReplaceItemInArray(cJSON* array,int which,cJSON* newitem);
 extern void cJSON_ReplaceItemInObject(cJSON* object,const char* string,cJSON* newitem);
 
+/* Binary encodings. The encoders return a buffer from the malloc hook and store its size in *len. Integral numbers are
+ * written as native integers and other numbers as float32 when that is exact, float64 otherwise. Trees nesting deeper than
+ * the decoders accept (1000 levels) are not encoded: the encoders return 0, so every encoding they produce decodes. */
+extern unsigned char* cJSON_PrintCBOR(const cJSON* item,size_t* len);
+extern unsigned char* cJSON_PrintMsgPack(const cJSON* item,size_t* len);
+/* The decoders accept exactly one data item spanning len bytes. The InSitu variants shift each string one byte to the left
+ * over its already-consumed header to make room for the NUL, so strings live in data and no string memory is allocated;
+ * data must outlive the tree. Combined with an arena installed through cJSON_InitHooks, decoding makes no malloc calls. */
+extern cJSON* cJSON_ParseCBOR(const unsigned char* data,size_t len);
+extern cJSON* cJSON_ParseCBORInSitu(unsigned char* data,size_t len);
+extern cJSON* cJSON_ParseMsgPack(const unsigned char* data,size_t len);
+extern cJSON* cJSON_ParseMsgPackInSitu(unsigned char* data,size_t len);
+
+/* Read-only snapshots. cJSON_PrintSnapshot/cJSON_WriteSnapshot serialize a tree into a position-independent image: a header,
+ * fixed-size nodes addressed by self-relative offsets (children of a container are contiguous) and a string table.
+ * cJSON_LoadSnapshot maps such a file read-only and returns its root after checking the header only; nothing is parsed
+ * or allocated, so the cost depends on the pages actually touched. cJSON_SnapshotRoot does the same for an image already
+ * in memory. Each node records its own index, from which the accessors find the header and check, in constant time, that
+ * every offset they follow stays inside the image: a corrupt image makes them return 0 (or wrong values), never read
+ * outside it. Trees of any depth can be written; snapshots written by other format versions are rejected. */
+typedef struct cJSON_SnapNode cJSON_SnapNode;
+extern unsigned char* cJSON_PrintSnapshot(const cJSON* item,size_t* len);
+extern int cJSON_WriteSnapshot(const cJSON* item,const char* path);
+extern const cJSON_SnapNode* cJSON_LoadSnapshot(const char* path);
+extern void cJSON_CloseSnapshot(const cJSON_SnapNode* root);
+extern const cJSON_SnapNode* cJSON_SnapshotRoot(const void* data,size_t len);
+extern int cJSON_SnapshotType(const cJSON_SnapNode* node);
+extern const char* cJSON_SnapshotKey(const cJSON_SnapNode* node);
+extern const char* cJSON_SnapshotString(const cJSON_SnapNode* node);
+extern double cJSON_SnapshotNumber(const cJSON_SnapNode* node);
+extern int cJSON_SnapshotGetArraySize(const cJSON_SnapNode* array);
+extern const cJSON_SnapNode* cJSON_SnapshotGetArrayItem(const cJSON_SnapNode* array,int item);
+extern const cJSON_SnapNode* cJSON_SnapshotGetObjectItem(const cJSON_SnapNode* object,const char* string);
+
+/* Struct binding: a cJSON_Binding describes a C struct as a table of fields (key, offset, type), and the calls below move
+ * data between JSON text and such structs directly, without building a tree. Keys match like cJSON_GetObjectItem
+ * (case-insensitive); keys without a field are skipped, together with their values, without allocating. */
+#define cJSON_FieldInt 0        /* int */
+#define cJSON_FieldDouble 1     /* double */
+#define cJSON_FieldBool 2       /* int, from true/false */
+#define cJSON_FieldString 3     /* char*, allocated with the malloc hook; 0 for null */
+#define cJSON_FieldChars 4      /* char[size], NUL-terminated; longer strings are an error */
+#define cJSON_FieldStruct 5     /* nested struct described by binding */
+
+typedef struct cJSON_Binding cJSON_Binding;
+typedef struct cJSON_Field
+{
+    const char* name;
+    size_t offset;
+    int type;
+    size_t size;
+    const cJSON_Binding* binding;
+} cJSON_Field;
+struct cJSON_Binding
+{
+    const cJSON_Field* fields;
+    int count;
+    size_t size;    /* sizeof the struct, the stride of struct arrays */
+};
+
+/* Field table entries, e.g. cJSON_BindField("Latitude", struct record, lat, cJSON_FieldDouble). */
+#define cJSON_BindField(name,st,member,type) { name, offsetof(st,member), type, sizeof(((st*)0)->member), 0 }
+#define cJSON_BindStruct(name,st,member,binding) { name, offsetof(st,member), cJSON_FieldStruct, sizeof(((st*)0)->member), binding }
+
+/* Fill *out from a JSON object. Fields absent from the text are left as they are; string fields are overwritten without
+ * freeing what they held. Returns 1 on success; 0 on malformed text or a value of the wrong type, with cJSON_GetErrorPtr
+ * at the offending text. A failed parse may leave some fields set, so zero the struct first and release it with cJSON_FreeStruct. */
+extern int cJSON_ParseStruct(const char* value,const cJSON_Binding* binding,void* out);
+/* Fill out[0..capacity) from a JSON array of objects. Returns the number of structs filled, or -1 on error,
+ * including an array longer than capacity. As with cJSON_ParseStruct, zero the array first; after an error free all
+ * capacity elements. */
+extern int cJSON_ParseStructArray(const char* value,const cJSON_Binding* binding,void* out,int capacity);
+/* Free the cJSON_FieldString fields of the struct (and of nested structs) and set them to 0. */
+extern void cJSON_FreeStruct(const cJSON_Binding* binding,void* s);
+/* Render structs as text in the same layout as cJSON_Print (fmt=1) or cJSON_PrintUnformatted (fmt=0). Free the char* when finished. */
+extern char* cJSON_PrintStruct(const cJSON_Binding* binding,const void* s,int fmt);
+extern char* cJSON_PrintStructArray(const cJSON_Binding* binding,const void* s,int count,int fmt);
+
+/* Token-level entry points: the scanners and formatters the parser, printer and struct binding use, for generated code
+ * (such as cjson_reflect.hpp) that walks JSON text itself. value points at the first character of a token. The parse calls
+ * return the position just after the token, or 0 (-1 for lengths) with cJSON_GetErrorPtr at value; they do not clear it. */
+extern void cJSON_SetErrorPtr(const char* at);
+/* Skip any value, nested arrays and objects included, without allocating. Only bracket nesting is checked. */
+extern const char* cJSON_SkipValue(const char* value);
+extern const char* cJSON_ParseNumberToken(const char* value,double* number);
+/* Upper bound of the decoded length of the string token at value (its opening quote), -1 if it is not a terminated string. */
+extern int cJSON_StringTokenLength(const char* value);
+/* Decode a string token that passed cJSON_StringTokenLength into out (that length + 1 bytes); *len gets the decoded length. */
+extern const char* cJSON_DecodeStringToken(const char* value,char* out,size_t* len);
+/* Format like cJSON_PrintUnformatted. Numbers need 64 bytes of out. Strings are quoted and escaped; the length (without
+ * the NUL) is always returned, and out is written only when size is larger than it. */
+extern size_t cJSON_PrintNumberToken(double number,char* out);
+extern size_t cJSON_PrintStringToken(const char* str,char* out,size_t size);
+
 extern cJSON *cJSON_Duplicate(cJSON *item,int recurse);
+/* Copy-on-write duplicate: O(1), the copy shares item's children until one side is changed. The replace/insert/detach/add/delete
+ * calls copy only the sibling list they modify; reach a nested node you want to change through the *Mutable getters, which copy
+ * each level on the way down, so the cost is proportional to the path instead of the whole document.
+ * Nodes returned by the plain getters may be shared and must not be changed in place. The share counts are atomic, so copies
+ * of one base tree can be taken, edited through these calls and deleted on different threads at once (e.g. a base config per
+ * request thread), as long as nothing edits the base itself in place meanwhile. cJSON_CacheHash writes into the nodes it
+ * visits, so cache hashes on the base before sharing it. */
+extern cJSON *cJSON_DuplicateShared(cJSON *item);
+extern cJSON *cJSON_GetArrayItemMutable(cJSON *array,int item);
+extern cJSON *cJSON_GetObjectItemMutable(cJSON *object,const char *string);
+
+/* Deep equality. Keys and strings compare byte for byte, numbers with ==; the key of a and b themselves is ignored.
+ * With unordered set, object members are matched by name regardless of order, each member of b at most once (members
+ * sharing a name pair up in document order); arrays stay ordered either way. Trees sharing child lists (cJSON_DuplicateShared) compare in O(1). */
+extern int cJSON_Compare(const cJSON *a,const cJSON *b,int unordered);
+/* Structural 64-bit hash, independent of object member order: trees equal under either cJSON_Compare mode hash alike. */
+extern unsigned long long cJSON_Hash(const cJSON *item);
+/* Same value as cJSON_Hash, and stores it on every array and object visited so later calls (and cJSON_Compare on
+ * unequal subtrees) reuse it. The add/insert/replace/detach/delete calls and the *Mutable getters clear the cache of the
+ * container they touch; nodes do not know their parents, so change nested nodes only through paths obtained with the
+ * *Mutable getters, which clear it on every level on the way down. Changing a node reached through the plain getters
+ * (or writing to it directly) leaves stale hashes on its ancestors: only call this on trees you then edit through the
+ * *Mutable getters, or call it again on a fresh cJSON_Duplicate. Nothing else in the library installs the cache.
+ * cJSON_DuplicateShared copies keep the cache, cJSON_Duplicate copies start without it. */
+extern unsigned long long cJSON_CacheHash(cJSON *item);
+
+/* JSON Patch (RFC 6902). cJSON_CreatePatch returns an array of add/remove/replace operations turning from into to, or 0
+ * when out of memory. It hashes both trees so unchanged subtrees are skipped, reusing hashes cached by cJSON_CacheHash;
+ * the hashes it computes itself are cleared again before it returns, so the trees are left as they were. Diffing a
+ * cJSON_DuplicateShared copy edited through the *Mutable getters only visits the edited paths. Operation values share
+ * structure with to (copy-on-write), so either tree can be changed or deleted afterwards.
+ * Arrays are diffed by trimming the common head and tail and pairing up what remains by position. */
+extern cJSON *cJSON_CreatePatch(cJSON *from,cJSON *to);
+/* Apply all six operations of patch to object in place, through the detach/insert/replace calls; a path of "" replaces
+ * the contents of object itself. Values are taken from patch copy-on-write, and moves relink the existing node.
+ * Returns 1 on success. On the first failing operation it returns 0 with cJSON_GetErrorPtr at that operation's path,
+ * leaving the operations before it applied; the failing operation itself changes nothing (a move whose target cannot
+ * be added puts the node back where it was). Object keys in paths match case-sensitively. */
+extern int cJSON_ApplyPatch(cJSON *object,cJSON *patch);
+
+/* JSON Merge Patch (RFC 7386). cJSON_ApplyMergePatch merges patch into target in place and always consumes patch: its
+ * nodes are moved into target, not copied (pass cJSON_DuplicateShared(patch) to keep it). Members are matched by exact
+ * name, through a hash table on wide objects; replaced members keep their position. A non-object patch, or an object
+ * patch on a non-object target, replaces the contents of target itself. Returns 0 only when out of memory, leaving
+ * target partly merged. */
+extern int cJSON_ApplyMergePatch(cJSON *target,cJSON *patch);
+/* Merge patch turning from into to: removed members become null, changed objects are diffed member by member, anything
+ * else is taken whole (copy-on-write, sharing structure with to). Caches hashes on both trees like cJSON_CreatePatch.
+ * As in RFC 7386, null member values inside to cannot be expressed and are dropped when the patch is applied. */
+extern cJSON *cJSON_CreateMergePatch(cJSON *from,cJSON *to);
+
+/* Remove whitespace outside strings (every byte <= 32, as the parser skips it) without parsing or allocating.
+ * cJSON_Minify works in place on a NUL-terminated text; cJSON_MinifyBuffer reads len bytes of json and writes the result
+ * and a NUL to out, which needs len + 1 bytes and may be json itself. Both return the new length. The text is not
+ * validated: strings are copied as they are, a backslash always keeps the byte after it (an escaped quote neither opens
+ * nor closes a string), and an unterminated string runs to the end. Comments are not recognised. */
+extern size_t cJSON_Minify(char *json);
+extern size_t cJSON_MinifyBuffer(const char *json,size_t len,char *out);
+
+/* Check that the len bytes at json are exactly one RFC 8259 value, without building a tree: strict number syntax, only
+ * the defined escapes with \u surrogates in pairs, no raw control characters and valid UTF-8 in strings, and only space,
+ * tab, CR and LF as whitespace (stricter than cJSON_Parse). Allocates nothing and does not recurse; nesting is limited
+ * like cJSON_Parse (cJSON_SetNestingLimit), but never beyond 65536 levels. Returns 1 if valid. Otherwise returns 0 and
+ * sets *error (when given) to the offset of the offending byte, len when the text ends early; cJSON_GetErrorPtr points there too. */
+extern int cJSON_Validate(const char *json,size_t len,size_t *error);
+
+/* Render item as canonical JSON (RFC 8785, JSON Canonicalization Scheme), suitable for hashing and signing: no
+ * whitespace, object members sorted by key in UTF-16 code-unit order, numbers in the shortest form that reads back to
+ * the same double (formatted like ECMAScript's Number.prototype.toString) and strings escaped minimally, as
+ * cJSON_PrintUnformatted does. The tree is left untouched; duplicate keys keep their relative order. Returns 0 when the
+ * tree holds a NaN or an infinity, which have no canonical form. Strings are printed as stored, so the result is only
+ * canonical when they are valid UTF-8 (parse with cJSON_SetStrictStrings to guarantee it). */
+extern char *cJSON_PrintCanonical(cJSON *item);
+
+/* JSONPath queries over a tree. cJSON_CompilePath parses an expression once into a reusable plan; it returns 0 on a
+ * syntax error, with cJSON_GetErrorPtr pointing at the offending character. Supported: the root $, child names (.name,
+ * ['name'] or ["name"]; dotted names run to the next '.' or '[', so $.web-app works), wildcards (.* and [*]),
+ * recursive descent (..name, ..* and ..[...]), array indexes ([2], [-1]), slices ([start:end:step] as in RFC 9535) and
+ * filters of the form [?(@.path)], [?(!@.path)] or [?(@.path op literal)], where path is a chain of .name, ['name'] and
+ * [index], op one of == != < <= > >= and literal a number, a quoted string, true, false or null (the parentheses are
+ * optional). Names match exactly, unlike cJSON_GetObjectItem. cJSON_PathQuery applies each step with one pass over a
+ * container's children (never by index from the head of the list) and stores the matching nodes, not copies, into
+ * results in the order RFC 9535 gives, at most capacity of them. It returns the total number of matches, so a call with capacity 0 sizes the array. The
+ * tree is walked without recursion, so recursive descent works at any depth; it returns 0 if memory for the walk runs
+ * out. The plan is read-only while running and can be shared between threads. */
+typedef struct cJSON_Path cJSON_Path;
+extern cJSON_Path *cJSON_CompilePath(const char *expr);
+extern size_t cJSON_PathQuery(const cJSON_Path *path,cJSON *root,cJSON **results,size_t capacity);
+extern void cJSON_DeletePath(cJSON_Path *path);
+
+/* Projection parsing: build only the requested parts of a document. cJSON_CreateProjection compiles count JSONPath
+ * expressions made of child names, non-negative array indexes and wildcards only (e.g. "$.user.name",
+ * "$.items[*].id"); it returns 0 if one does not compile or uses other selectors. cJSON_ParseProjected then parses
+ * value like cJSON_Parse, but values that no path selects are skipped by scanning brackets and quotes, without creating
+ * nodes or decoding strings; skipped text is checked for matching brackets, commas and colons in place and terminated
+ * strings, while string contents are not decoded and numbers are only checked for their characters. A selected
+ * value is kept whole. Arrays and objects on the way to a selection are kept, in document order, with just the
+ * selected members (possibly none); scalars on the way, which cannot hold a selection, are dropped. Skipped array
+ * elements leave no gap, so indexes in the result can differ from the text. The projection is read-only while parsing
+ * and can be shared between threads. */
+typedef struct cJSON_Projection cJSON_Projection;
+extern cJSON_Projection *cJSON_CreateProjection(const char *const *paths,int count);
+extern cJSON *cJSON_ParseProjected(const char *value,const cJSON_Projection *projection);
+extern void cJSON_DeleteProjection(cJSON_Projection *projection);
+
+/* Multi-path extraction from raw text: cJSON_Extract scans value once, front to back, and stores into results[i] what
+ * paths[i] selects, building no tree and allocating nothing. Paths are JSONPath chains of child names and non-negative
+ * array indexes ("$.level", "$['@timestamp']", "$.tags[0]"); names match exactly and the first matching member wins.
+ * Only the members a path goes through are entered; everything else is skipped by scanning brackets and quotes, and
+ * the scan stops as soon as every path has a result, so the rest of the text is neither read nor checked. Returns the
+ * number of paths found, or -1 for a malformed path (nothing is scanned) or malformed text before the scan finished,
+ * with cJSON_GetErrorPtr at the offending character; results found before the error are kept. An array or object is
+ * returned only after its whole span has been scanned the same way as skipped text, so its brackets match. */
+typedef struct cJSON_Extracted
+{
+    int type;               /* cJSON_False .. cJSON_Object, or -1 when the path is not in the text */
+    int valueint;
+    double valuedouble;     /* numbers only */
+    const char *start;      /* raw text of the value, pointing into value; for strings the bytes between the quotes */
+    size_t length;
+    int escaped;            /* the string holds escape sequences; cJSON_ExtractedString decodes it */
+} cJSON_Extracted;
+extern int cJSON_Extract(const char *value,const char *const *paths,int count,cJSON_Extracted *results);
+/* Copy a string result into buffer, decoding escapes, and NUL-terminate it. buffer needs length + 1 bytes, which is
+ * always enough; returns buffer, or 0 when result is not a string or size is too small. */
+extern char *cJSON_ExtractedString(const cJSON_Extracted *result,char *buffer,size_t size);
 
 #ifdef __cplusplus
 }
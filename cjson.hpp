@@ -0,0 +1,335 @@
+// 避免头文件重复引用
+#ifndef cjson__hpp
+#define cjson__hpp
+
+/* Header-only C++17 layer over cjson.h. Nothing here allocates or copies beyond what the C calls do:
+ *   cjson::document  move-only owner of a parsed or built tree, deleted with cJSON_Delete
+ *   cjson::node      non-owning view of one cJSON node; a null view stands for "missing" and every accessor accepts it
+ *   cjson::text      move-only owner of printed output, released through the free hook
+ * Keys and string values are returned as std::string_view. Lookups compare a std::string_view key against each member
+ * name in place, case-insensitively (ASCII) like cJSON_GetObjectItem, without strlen or a temporary std::string. */
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "cjson.h"
+
+namespace cjson
+{
+
+enum class type : int
+{
+    false_ = cJSON_False,
+    true_ = cJSON_True,
+    null = cJSON_NULL,
+    number = cJSON_Number,
+    string = cJSON_String,
+    array = cJSON_Array,
+    object = cJSON_Object,
+    invalid = -1
+};
+
+namespace detail
+{
+
+// C++中std::tolower不能内联，每个字符都是一次函数调用；在默认的"C" locale下两者结果相同
+constexpr char ascii_lower(char c) noexcept
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// 饱和转换，超出范围的double转成整数是未定义行为
+template <class T>
+T to_integer(double d) noexcept
+{
+    if (d != d)
+    {
+        return T();
+    }
+    if (d <= static_cast<double>(std::numeric_limits<T>::min()))
+    {
+        return std::numeric_limits<T>::min();
+    }
+    // max()转成double后可能向上取整，等于它时已经溢出
+    if (d >= static_cast<double>(std::numeric_limits<T>::max()))
+    {
+        return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(d);
+}
+
+}
+
+class text;
+
+/* Non-owning view of a node. Cheap to copy; valid as long as the tree it points into. */
+class node
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = node;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const node*;
+        using reference = node;
+
+        iterator() noexcept : cur_(nullptr) {}
+        explicit iterator(cJSON* cur) noexcept : cur_(cur) {}
+        node operator*() const noexcept { return node(cur_); }
+        iterator& operator++() noexcept { cur_ = cur_->next; return *this; }
+        iterator operator++(int) noexcept { iterator old = *this; cur_ = cur_->next; return old; }
+        bool operator==(const iterator& other) const noexcept { return cur_ == other.cur_; }
+        bool operator!=(const iterator& other) const noexcept { return cur_ != other.cur_; }
+
+    private:
+        cJSON* cur_;
+    };
+
+    node() noexcept : p_(nullptr) {}
+    explicit node(cJSON* p) noexcept : p_(p) {}
+
+    cJSON* get() const noexcept { return p_; }
+    explicit operator bool() const noexcept { return p_ != nullptr; }
+
+    cjson::type type() const noexcept { return p_ ? static_cast<cjson::type>(p_->type & 255) : cjson::type::invalid; }
+    bool is_null() const noexcept { return type() == cjson::type::null; }
+    bool is_bool() const noexcept { return type() == cjson::type::true_ || type() == cjson::type::false_; }
+    bool is_number() const noexcept { return type() == cjson::type::number; }
+    bool is_string() const noexcept { return type() == cjson::type::string; }
+    bool is_array() const noexcept { return type() == cjson::type::array; }
+    bool is_object() const noexcept { return type() == cjson::type::object; }
+
+    /* Member name inside an object, empty otherwise. */
+    std::string_view key() const noexcept
+    {
+        return p_ && p_->string ? std::string_view(p_->string) : std::string_view();
+    }
+
+    /* Children of an array or object; empty for anything else. */
+    iterator begin() const noexcept { return iterator(p_ && is_container() ? p_->child : nullptr); }
+    iterator end() const noexcept { return iterator(); }
+    bool empty() const noexcept { return begin() == end(); }
+    std::size_t size() const noexcept
+    {
+        std::size_t n = 0;
+        for (iterator it = begin(); it != end(); ++it)
+        {
+            n++;
+        }
+        return n;
+    }
+
+    /* Object member by name; a null view when absent or when this is not an object. */
+    node operator[](std::string_view name) const noexcept
+    {
+        if (!is_object())
+        {
+            return node();
+        }
+        for (cJSON* c = p_->child; c; c = c->next)
+        {
+            if (key_equal(c->string,name))
+            {
+                return node(c);
+            }
+        }
+        return node();
+    }
+    node operator[](const char* name) const noexcept { return (*this)[std::string_view(name)]; }
+    node operator[](const std::string& name) const noexcept { return (*this)[std::string_view(name)]; }
+
+    /* Array element by position; a null view when out of range or when this is not an array. */
+    node operator[](std::size_t index) const noexcept
+    {
+        if (!is_array())
+        {
+            return node();
+        }
+        cJSON* c = p_->child;
+        while (c && index--)
+        {
+            c = c->next;
+        }
+        return node(c);
+    }
+    node operator[](int index) const noexcept { return index < 0 ? node() : (*this)[static_cast<std::size_t>(index)]; }
+
+    /* Whether get<T>() would read a value of the node rather than fall back to T{}. */
+    template <class T>
+    bool is() const noexcept
+    {
+        if constexpr (std::is_same_v<T,bool>)
+        {
+            return is_bool();
+        }else if constexpr (std::is_arithmetic_v<T>)
+        {
+            return is_number();
+        }else if constexpr (std::is_same_v<T,std::string_view> || std::is_same_v<T,const char*> || std::is_same_v<T,std::string>)
+        {
+            return is_string();
+        }else{
+            static_assert(unsupported<T>::value,"cjson::node::is<T>: T must be bool, an arithmetic type, std::string_view, const char* or std::string");
+            return false;
+        }
+    }
+
+    /* Typed value: bool, any integer type (saturated, NaN gives 0), float/double, std::string_view, const char* or std::string.
+     * A node of another type, or a null view, gives T{}. */
+    template <class T>
+    T get() const
+    {
+        if constexpr (std::is_same_v<T,bool>)
+        {
+            return type() == cjson::type::true_;
+        }else if constexpr (std::is_integral_v<T>)
+        {
+            return is_number() ? detail::to_integer<T>(cJSON_GetNumberValue(p_)) : T();
+        }else if constexpr (std::is_floating_point_v<T>)
+        {
+            return is_number() ? static_cast<T>(cJSON_GetNumberValue(p_)) : T();
+        }else if constexpr (std::is_same_v<T,std::string_view>)
+        {
+            return is_string() ? std::string_view(p_->valuestring) : std::string_view();
+        }else if constexpr (std::is_same_v<T,const char*>)
+        {
+            return is_string() ? static_cast<const char*>(p_->valuestring) : nullptr;
+        }else if constexpr (std::is_same_v<T,std::string>)
+        {
+            return is_string() ? std::string(p_->valuestring) : std::string();
+        }else{
+            static_assert(unsupported<T>::value,"cjson::node::get<T>: T must be bool, an arithmetic type, std::string_view, const char* or std::string");
+            return T();
+        }
+    }
+
+    /* get<T>() when is<T>(), fallback otherwise. */
+    template <class T>
+    T get_or(T fallback) const
+    {
+        return is<T>() ? get<T>() : fallback;
+    }
+
+    inline text print() const;
+    inline text print_unformatted() const;
+
+private:
+    template <class T>
+    struct unsupported : std::false_type {};
+
+    bool is_container() const noexcept { return is_array() || is_object(); }
+
+    static bool key_equal(const char* s,std::string_view name) noexcept
+    {
+        if (!s)
+        {
+            return false;
+        }
+        for (char c : name)
+        {
+            // 先检查键是否已经结束：name中间可能有'\0'，不能越过键的结尾；字节相同时不必转换大小写
+            if (!*s || (*s != c && detail::ascii_lower(*s) != detail::ascii_lower(c)))
+            {
+                return false;
+            }
+            s++;
+        }
+        return !*s;
+    }
+
+    cJSON* p_;
+};
+
+/* Printed output. Move-only; frees the buffer through cJSON_Free. */
+class text
+{
+public:
+    text() noexcept : s_(nullptr) {}
+    explicit text(char* adopt) noexcept : s_(adopt) {}
+    text(text&& other) noexcept : s_(other.s_) { other.s_ = nullptr; }
+    text& operator=(text&& other) noexcept
+    {
+        if (this != &other)
+        {
+            cJSON_Free(s_);
+            s_ = other.s_;
+            other.s_ = nullptr;
+        }
+        return *this;
+    }
+    text(const text&) = delete;
+    text& operator=(const text&) = delete;
+    ~text() { cJSON_Free(s_); }
+
+    explicit operator bool() const noexcept { return s_ != nullptr; }
+    const char* c_str() const noexcept { return s_; }
+    std::string_view view() const noexcept { return s_ ? std::string_view(s_) : std::string_view(); }
+    operator std::string_view() const noexcept { return view(); }
+    /* Give up ownership; free the result with cJSON_Free. */
+    char* release() noexcept { char* s = s_; s_ = nullptr; return s; }
+
+private:
+    char* s_;
+};
+
+inline text node::print() const { return text(p_ ? cJSON_Print(p_) : nullptr); }
+inline text node::print_unformatted() const { return text(p_ ? cJSON_PrintUnformatted(p_) : nullptr); }
+
+/* Owner of a whole tree. Move-only; the tree is deleted with cJSON_Delete. An empty document means the parse failed,
+ * and cJSON_GetErrorPtr tells where. */
+class document
+{
+public:
+    document() noexcept : root_(nullptr) {}
+    explicit document(cJSON* adopt) noexcept : root_(adopt) {}
+    document(document&& other) noexcept : root_(other.root_) { other.root_ = nullptr; }
+    document& operator=(document&& other) noexcept
+    {
+        if (this != &other)
+        {
+            cJSON_Delete(root_);
+            root_ = other.root_;
+            other.root_ = nullptr;
+        }
+        return *this;
+    }
+    document(const document&) = delete;
+    document& operator=(const document&) = delete;
+    ~document() { cJSON_Delete(root_); }
+
+    static document parse(const char* value) { return document(value ? cJSON_Parse(value) : nullptr); }
+    static document parse(const std::string& value) { return document(cJSON_Parse(value.c_str())); }
+    static document parse_file(const char* path) { return document(cJSON_ParseFile(path)); }
+
+    /* Deep copy; the one way to get a second owner. */
+    document duplicate() const { return document(root_ ? cJSON_Duplicate(root_,1) : nullptr); }
+
+    explicit operator bool() const noexcept { return root_ != nullptr; }
+    cJSON* get() const noexcept { return root_; }
+    /* Give up ownership; delete the result with cJSON_Delete. */
+    cJSON* release() noexcept { cJSON* r = root_; root_ = nullptr; return r; }
+
+    node root() const noexcept { return node(root_); }
+    node operator[](std::string_view name) const noexcept { return root()[name]; }
+    node operator[](const char* name) const noexcept { return root()[name]; }
+    node operator[](const std::string& name) const noexcept { return root()[name]; }
+    node operator[](std::size_t index) const noexcept { return root()[index]; }
+    node operator[](int index) const noexcept { return root()[index]; }
+    node::iterator begin() const noexcept { return root().begin(); }
+    node::iterator end() const noexcept { return root().end(); }
+
+    text print() const { return root().print(); }
+    text print_unformatted() const { return root().print_unformatted(); }
+
+private:
+    cJSON* root_;
+};
+
+}
+
+#endif
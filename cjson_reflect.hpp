@@ -0,0 +1,570 @@
+// 避免头文件重复引用
+#ifndef cjson_reflect__hpp
+#define cjson_reflect__hpp
+
+/* Compile-time struct serialization for C++17, the templated counterpart of cJSON_Binding. Declare the members of a struct
+ * once, in the global namespace:
+ *
+ *     struct record { std::string precision; double lat, lon; std::string address, city, state, zip, country; };
+ *     CJSON_REFLECT(record,
+ *         field("precision", &record::precision), field("Latitude", &record::lat), field("Longitude", &record::lon), ...);
+ *
+ * and cjson::from_json / cjson::to_json read and write it without building a tree. Each struct gets its own parse and print
+ * functions: incoming keys are dispatched through a perfect hash computed at compile time, and the quoted, escaped key text
+ * (with its leading '{' or ',') is a compile-time constant. Numbers and string values go through the library's own token
+ * scanners and formatters, so the text read and written is exactly what cJSON_Parse and cJSON_PrintUnformatted accept and produce.
+ * The exception is integer members, which never pass through double: they are written with std::to_chars and, when the
+ * token has no fraction or exponent, read with std::from_chars, so 64-bit values beyond 2^53 keep every digit.
+ *
+ * Member types: bool, arithmetic types (integers saturate, as in cjson::node::get), std::string (up to its first NUL when
+ * printed), std::vector of any member type, and other reflected structs. Keys match case-insensitively (ASCII), like
+ * cJSON_GetObjectItem; unknown members are skipped without allocating. null leaves a member unchanged, except that it
+ * empties strings and vectors. */
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "cjson.hpp"
+
+namespace cjson
+{
+
+template <class S,class M>
+struct field_t
+{
+    const char* name;
+    M S::* member;
+};
+
+template <class S,class M>
+constexpr field_t<S,M> field(const char* name,M S::* member)
+{
+    return field_t<S,M>{name,member};
+}
+
+/* Specialize with a static constexpr tuple of field(...) entries named fields, or use CJSON_REFLECT. */
+template <class T>
+struct reflect;
+
+#define CJSON_REFLECT(T,...) \
+    template <> struct cjson::reflect<T> { static constexpr auto fields = std::make_tuple(__VA_ARGS__); }
+
+namespace detail
+{
+
+template <class T,class = void>
+struct is_reflected : std::false_type {};
+template <class T>
+struct is_reflected<T,std::void_t<decltype(reflect<T>::fields)>> : std::true_type {};
+
+template <class T>
+struct is_vector : std::false_type {};
+template <class T,class A>
+struct is_vector<std::vector<T,A>> : std::true_type {};
+
+template <class T>
+struct unsupported : std::false_type {};
+
+template <class T>
+constexpr std::size_t field_count = std::tuple_size_v<std::decay_t<decltype(reflect<T>::fields)>>;
+
+template <class T,std::size_t I>
+constexpr const char* field_name = std::get<I>(reflect<T>::fields).name;
+
+constexpr std::size_t length(const char* s)
+{
+    std::size_t n = 0;
+    while (s[n])
+    {
+        n++;
+    }
+    return n;
+}
+
+// 键名的哈希：FNV-1a，按小写计算，保证不区分大小写的匹配落在同一个槽
+constexpr std::uint32_t key_hash(std::uint32_t seed,const char* s,std::size_t len)
+{
+    std::uint32_t h = 2166136261u ^ seed;
+    for (std::size_t i = 0; i < len; i++)
+    {
+        h = (h ^ static_cast<unsigned char>(ascii_lower(s[i]))) * 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+constexpr bool key_equal(const char* name,const char* key,std::size_t len)
+{
+    for (std::size_t i = 0; i < len; i++)
+    {
+        if (name[i] != key[i] && (!name[i] || ascii_lower(name[i]) != ascii_lower(key[i])))
+        {
+            return false;
+        }
+    }
+    return !name[len];
+}
+
+// 编译期求值时调用非constexpr函数会报错，用来拒绝重复的键名
+inline void duplicate_field_name() {}
+
+// 完美哈希表：槽中存放字段序号+1，0表示空槽。槽数取不小于字段数平方的2的幂，随机种子大约一半的概率没有冲突
+template <std::size_t N>
+struct key_table
+{
+    static constexpr std::size_t size = [] {
+        std::size_t n = 2;
+        while (n < N * N)
+        {
+            n *= 2;
+        }
+        return n;
+    }();
+    std::uint32_t seed;
+    std::uint8_t slots[size];
+};
+
+template <class T,std::size_t... I>
+constexpr key_table<sizeof...(I)> make_key_table(std::index_sequence<I...>)
+{
+    constexpr std::size_t n = sizeof...(I);
+    static_assert(n < 255,"cjson::reflect: too many fields");
+    const char* list[n + 1] = {field_name<T,I>...,nullptr};
+    key_table<n> t{};
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = 0; j < i; j++)
+        {
+            if (key_equal(list[i],list[j],length(list[j])))
+            {
+                duplicate_field_name();
+            }
+        }
+    }
+    for (std::uint32_t seed = 0;; seed++)
+    {
+        bool ok = true;
+        t.seed = seed;
+        for (std::size_t i = 0; i < key_table<n>::size; i++)
+        {
+            t.slots[i] = 0;
+        }
+        for (std::size_t i = 0; i < n && ok; i++)
+        {
+            std::uint8_t& slot = t.slots[key_hash(seed,list[i],length(list[i])) & (key_table<n>::size - 1)];
+            ok = !slot;
+            slot = static_cast<std::uint8_t>(i + 1);
+        }
+        if (ok)
+        {
+            return t;
+        }
+    }
+}
+
+template <class T>
+constexpr auto keys = make_key_table<T>(std::make_index_sequence<field_count<T>>());
+
+template <class T,std::size_t... I>
+constexpr std::array<const char*,sizeof...(I) + 1> make_names(std::index_sequence<I...>)
+{
+    return {{field_name<T,I>...,nullptr}};
+}
+
+template <class T>
+constexpr auto names = make_names<T>(std::make_index_sequence<field_count<T>>());
+
+// 字段序号，没有这个键时返回-1
+template <class T>
+int find_field(const char* key,std::size_t len)
+{
+    constexpr const auto& t = keys<T>;
+    std::uint8_t slot = t.slots[key_hash(t.seed,key,len) & (t.size - 1)];
+    if (!slot || !key_equal(names<T>[slot - 1],key,len))
+    {
+        return -1;
+    }
+    return slot - 1;
+}
+
+// 打印时键名部分的文本：开头的'{'或','、带引号和转义的键名、冒号，编译期生成
+constexpr std::size_t escaped_key_length(const char* s)
+{
+    std::size_t n = 0;
+    for (; *s; s++)
+    {
+        unsigned char c = static_cast<unsigned char>(*s);
+        n += (c == '\"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t') ? 2 : (c < 32 ? 6 : 1);
+    }
+    return n;
+}
+
+template <class T,std::size_t I>
+struct key_text
+{
+    static constexpr std::size_t size = escaped_key_length(field_name<T,I>) + 4;
+    static constexpr std::array<char,size> text = [] {
+        constexpr const char* hex = "0123456789abcdef";
+        std::array<char,size> out{};
+        std::size_t n = 0;
+        out[n++] = I ? ',' : '{';
+        out[n++] = '\"';
+        for (const char* s = field_name<T,I>; *s; s++)
+        {
+            unsigned char c = static_cast<unsigned char>(*s);
+            const char esc = c == '\"' ? '\"' : c == '\\' ? '\\' : c == '\b' ? 'b' : c == '\f' ? 'f' :
+                             c == '\n' ? 'n' : c == '\r' ? 'r' : c == '\t' ? 't' : 0;
+            if (esc)
+            {
+                out[n++] = '\\';
+                out[n++] = esc;
+            }else if (c < 32)
+            {
+                out[n++] = '\\';
+                out[n++] = 'u';
+                out[n++] = '0';
+                out[n++] = '0';
+                out[n++] = hex[c >> 4];
+                out[n++] = hex[c & 15];
+            }else{
+                out[n++] = static_cast<char>(c);
+            }
+        }
+        out[n++] = '\"';
+        out[n++] = ':';
+        return out;
+    }();
+};
+
+// 与cjson.c中的skip相同
+inline const char* skip(const char* p)
+{
+    while (*p && static_cast<unsigned char>(*p) <= 32)
+    {
+        p++;
+    }
+    return p;
+}
+
+inline const char* fail(const char* at)
+{
+    cJSON_SetErrorPtr(at);
+    return nullptr;
+}
+
+// 整数成员不经过double，double只有53位尾数，64位整数会被舍入。数字的语法和结尾仍由cJSON_ParseNumberToken检查，
+// 没有小数和指数时用std::from_chars精确转换，超出范围时按符号饱和；其余情况(有小数或指数、无符号类型遇到负数)
+// 按double取值后饱和，和cjson::node::get一致
+template <class T>
+const char* parse_integer(const char* p,T& out)
+{
+    double d;
+    const char* end = cJSON_ParseNumberToken(p,&d);
+    const char* c;
+    std::from_chars_result r;
+    if (!end)
+    {
+        return nullptr;
+    }
+    for (c = p;c != end && *c != '.' && *c != 'e' && *c != 'E';c++)
+    {
+    }
+    if (c == end)
+    {
+        r = std::from_chars(p,end,out);
+        if (r.ec == std::errc::result_out_of_range)
+        {
+            out = *p == '-' ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+            return end;
+        }
+        if (r.ec == std::errc() && r.ptr == end)
+        {
+            return end;
+        }
+    }
+    out = to_integer<T>(d);
+    return end;
+}
+
+template <class T>
+const char* parse_value(const char* p,T& out);
+
+template <class T,std::size_t I>
+const char* parse_member(const char* p,T& out)
+{
+    return parse_value(p,out.*(std::get<I>(reflect<T>::fields).member));
+}
+
+template <class T>
+using member_parser = const char* (*)(const char*,T&);
+
+template <class T,std::size_t... I>
+constexpr std::array<member_parser<T>,sizeof...(I)> make_parsers(std::index_sequence<I...>)
+{
+    return {{&parse_member<T,I>...}};
+}
+
+template <class T>
+const char* parse_object(const char* p,T& out)
+{
+    static constexpr auto parsers = make_parsers<T>(std::make_index_sequence<field_count<T>>());
+    const char* key;
+    const char* end;
+    bool escaped;
+    int index;
+    if (*p != '{')
+    {
+        return fail(p);
+    }
+    p = skip(p + 1);
+    if (*p == '}')
+    {
+        return p + 1;
+    }
+    for (;;)
+    {
+        key = p;
+        if (*p != '\"')
+        {
+            return fail(p);
+        }
+        escaped = false;
+        for (end = p + 1; *end != '\"'; end++)
+        {
+            if (*end == '\\')
+            {
+                escaped = true;
+                end++;
+            }
+            if (!*end)
+            {
+                return fail(key);
+            }
+        }
+        if (!escaped)
+        {
+            index = find_field<T>(key + 1,end - key - 1);
+        }else{
+            // 带转义的键先解码；字段名不会有这么长，放不下的键一定不匹配
+            char buf[256];
+            std::size_t len;
+            index = -1;
+            if (cJSON_StringTokenLength(key) < static_cast<int>(sizeof(buf)))
+            {
+                cJSON_DecodeStringToken(key,buf,&len);
+                index = find_field<T>(buf,len);
+            }
+        }
+        p = skip(end + 1);
+        if (*p != ':')
+        {
+            return fail(p);
+        }
+        p = skip(p + 1);
+        p = index >= 0 ? parsers[index](p,out) : cJSON_SkipValue(p);
+        if (!p)
+        {
+            return nullptr;
+        }
+        p = skip(p);
+        if (*p == '}')
+        {
+            return p + 1;
+        }
+        if (*p != ',')
+        {
+            return fail(p);
+        }
+        p = skip(p + 1);
+    }
+}
+
+template <class T>
+const char* parse_value(const char* p,T& out)
+{
+    if (!std::strncmp(p,"null",4))
+    {
+        if constexpr (std::is_same_v<T,std::string> || is_vector<T>::value)
+        {
+            out.clear();
+        }
+        return p + 4;
+    }
+    if constexpr (std::is_same_v<T,bool>)
+    {
+        if (!std::strncmp(p,"true",4))
+        {
+            out = true;
+            return p + 4;
+        }
+        if (!std::strncmp(p,"false",5))
+        {
+            out = false;
+            return p + 5;
+        }
+        return fail(p);
+    }else if constexpr (std::is_integral_v<T>)
+    {
+        return parse_integer(p,out);
+    }else if constexpr (std::is_arithmetic_v<T>)
+    {
+        double d;
+        p = cJSON_ParseNumberToken(p,&d);
+        if (p)
+        {
+            out = static_cast<T>(d);
+        }
+        return p;
+    }else if constexpr (std::is_same_v<T,std::string>)
+    {
+        int len = cJSON_StringTokenLength(p);
+        std::size_t n;
+        if (len < 0)
+        {
+            return nullptr;
+        }
+        // resize之后data()有len+1个字节，最后一个是结尾的'\0'
+        out.resize(len);
+        p = cJSON_DecodeStringToken(p,out.data(),&n);
+        out.resize(n);
+        return p;
+    }else if constexpr (is_vector<T>::value)
+    {
+        if (*p != '[')
+        {
+            return fail(p);
+        }
+        out.clear();
+        p = skip(p + 1);
+        if (*p == ']')
+        {
+            return p + 1;
+        }
+        for (;;)
+        {
+            out.emplace_back();
+            p = parse_value(p,out.back());
+            if (!p)
+            {
+                return nullptr;
+            }
+            p = skip(p);
+            if (*p == ']')
+            {
+                return p + 1;
+            }
+            if (*p != ',')
+            {
+                return fail(p);
+            }
+            p = skip(p + 1);
+        }
+    }else if constexpr (is_reflected<T>::value)
+    {
+        return parse_object(p,out);
+    }else{
+        static_assert(unsupported<T>::value,"cjson::from_json: member type must be bool, arithmetic, std::string, std::vector or reflected");
+        return nullptr;
+    }
+}
+
+template <class T>
+void print_value(std::string& out,const T& value);
+
+template <class T,std::size_t... I>
+void print_members(std::string& out,const T& value,std::index_sequence<I...>)
+{
+    ((out.append(key_text<T,I>::text.data(),key_text<T,I>::size),
+      print_value(out,value.*(std::get<I>(reflect<T>::fields).member))),...);
+}
+
+template <class T>
+void print_value(std::string& out,const T& value)
+{
+    if constexpr (std::is_same_v<T,bool>)
+    {
+        out.append(value ? "true" : "false");
+    }else if constexpr (std::is_integral_v<T>)
+    {
+        // 和cJSON_PrintNumberToken打印可以精确表示的整数时一样，只是不经过double
+        char buf[std::numeric_limits<T>::digits10 + 3];
+        out.append(buf,std::to_chars(buf,buf + sizeof(buf),value).ptr);
+    }else if constexpr (std::is_arithmetic_v<T>)
+    {
+        char buf[64];
+        out.append(buf,cJSON_PrintNumberToken(static_cast<double>(value),buf));
+    }else if constexpr (std::is_same_v<T,std::string>)
+    {
+        std::size_t len = cJSON_PrintStringToken(value.c_str(),nullptr,0);
+        std::size_t old = out.size();
+        // 多出的一个字节是std::string自带的结尾'\0'
+        out.resize(old + len);
+        cJSON_PrintStringToken(value.c_str(),out.data() + old,len + 1);
+    }else if constexpr (is_vector<T>::value)
+    {
+        out.push_back('[');
+        for (std::size_t i = 0; i < value.size(); i++)
+        {
+            if (i)
+            {
+                out.push_back(',');
+            }
+            print_value(out,value[i]);
+        }
+        out.push_back(']');
+    }else if constexpr (is_reflected<T>::value)
+    {
+        if constexpr (field_count<T> == 0)
+        {
+            out.append("{}");
+        }else{
+            print_members(out,value,std::make_index_sequence<field_count<T>>());
+            out.push_back('}');
+        }
+    }else{
+        static_assert(unsupported<T>::value,"cjson::to_json: member type must be bool, arithmetic, std::string, std::vector or reflected");
+    }
+}
+
+}
+
+/* Read text (a reflected struct, a vector of them, or any member type) into out. Returns false on malformed text or a value
+ * of the wrong type, with cJSON_GetErrorPtr at the offending text; out may then be partly filled. */
+template <class T>
+bool from_json(const char* text,T& out)
+{
+    cJSON_SetErrorPtr(nullptr);
+    return text && detail::parse_value(detail::skip(text),out);
+}
+
+template <class T>
+bool from_json(const std::string& text,T& out)
+{
+    return from_json(text.c_str(),out);
+}
+
+/* Append value as unformatted JSON, the same text cJSON_PrintUnformatted gives for the equivalent tree. */
+template <class T>
+void append_json(std::string& out,const T& value)
+{
+    detail::print_value(out,value);
+}
+
+template <class T>
+std::string to_json(const T& value)
+{
+    std::string out;
+    detail::print_value(out,value);
+    return out;
+}
+
+}
+
+#endif